@@ -1,11 +1,78 @@
 #version 460 core
 
-uniform mat4 u_LightSpaceMatrix;
+// Inputs of the shaders drawing from the mesh buffer, decoded according
+// to the formats the Renderer picked. The same in Mesh, Depth, Shadow,
+// Mask and Lighting
+
+// 0: mat4, 1: top three rows, 2: position and scale, then a quaternion
+uniform int u_InstanceFormat;
+// 0: floats, 1: 16-bit position and 12-bit octahedral normal, packed into
+// integers below 2^24 that the floats hold as values, then float texture
+// coordinates
+uniform int u_VertexFormat;
 
 layout(location = 0) in vec3 a_Position;
-layout(location = 3) in mat4 a_Transform;
+layout(location = 1) in vec3 a_Normal;
+layout(location = 2) in vec2 a_TexCoords;
+layout(location = 3) in vec4 a_Instance0;
+layout(location = 4) in vec4 a_Instance1;
+layout(location = 5) in vec4 a_Instance2;
+layout(location = 6) in vec4 a_Instance3;
+
+mat4 InstanceTransform()
+{
+    if(u_InstanceFormat == 1)
+        return transpose(
+            mat4(a_Instance0, a_Instance1, a_Instance2, vec4(0.0, 0.0, 0.0, 1.0)));
+
+    if(u_InstanceFormat == 2) {
+        vec4 q = a_Instance1;
+        vec3 q2 = q.xyz * 2.0;
+        mat3 r = mat3(
+            1.0 - q2.y * q.y - q2.z * q.z, q2.x * q.y + q2.z * q.w, q2.x * q.z - q2.y * q.w,
+            q2.x * q.y - q2.z * q.w, 1.0 - q2.x * q.x - q2.z * q.z, q2.y * q.z + q2.x * q.w,
+            q2.x * q.z + q2.y * q.w, q2.y * q.z - q2.x * q.w, 1.0 - q2.x * q.x - q2.y * q.y);
+        r *= a_Instance0.w;
+        return mat4(vec4(r[0], 0.0), vec4(r[1], 0.0), vec4(r[2], 0.0),
+                    vec4(a_Instance0.xyz, 1.0));
+    }
+
+    return mat4(a_Instance0, a_Instance1, a_Instance2, a_Instance3);
+}
+
+vec3 VertexPosition()
+{
+    if(u_VertexFormat == 1) {
+        uvec2 w = uvec2(a_Position.xy);
+        uvec3 q = uvec3(w & 0xFFFFu, (w.x >> 16) | ((w.y >> 16) << 8));
+        return vec3(q) / 65535.0;
+    }
+    return a_Position;
+}
+
+vec3 VertexNormal()
+{
+    if(u_VertexFormat != 1)
+        return a_Normal;
+
+    uint w = uint(a_Normal.x);
+    vec2 e = vec2(uvec2(w & 0xFFFu, w >> 12)) / 2047.0 - 1.0;
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if(n.z < 0.0)
+        n.xy = (1.0 - abs(n.yx))
+             * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    return normalize(n);
+}
+
+vec2 VertexTexCoords()
+{
+    return a_TexCoords;
+}
+
+uniform mat4 u_LightSpaceMatrix;
 
 void main()
 {
-    gl_Position = u_LightSpaceMatrix * a_Transform * vec4(a_Position, 1.0);
+    mat4 transform = InstanceTransform();
+    gl_Position = u_LightSpaceMatrix * transform * vec4(VertexPosition(), 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,14 @@
+#version 460 core
+
+layout(location = 0) in vec2 v_Corner;
+layout(location = 1) in vec4 v_Color;
+
+layout(location = 0) out vec4 FragColor;
+
+void main()
+{
+    if(dot(v_Corner, v_Corner) > 1.0)
+        discard;
+
+    FragColor = v_Color;
+}
\ No newline at end of file
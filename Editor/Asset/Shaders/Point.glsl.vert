@@ -0,0 +1,35 @@
+#version 460 core
+
+uniform mat4 u_ViewProj;
+uniform vec2 u_ViewportSize;
+
+const vec2 Corners[6] =
+    vec2[6](
+        vec2(-1.0, -1.0),
+        vec2( 1.0, -1.0),
+        vec2( 1.0,  1.0),
+        vec2( 1.0,  1.0),
+        vec2(-1.0,  1.0),
+        vec2(-1.0, -1.0)
+    );
+
+layout(location = 0) in vec3 a_Position;
+layout(location = 1) in float a_Size;
+layout(location = 2) in vec4 a_Color;
+
+layout(location = 0) out vec2 v_Corner;
+layout(location = 1) out vec4 v_Color;
+
+void main()
+{
+    vec2 corner = Corners[gl_VertexID];
+    vec4 position = u_ViewProj * vec4(a_Position, 1.0);
+
+    // Half the size in pixels either way, kept constant on screen
+    position.xy += corner * a_Size / u_ViewportSize * position.w;
+
+    v_Corner = corner;
+    v_Color = a_Color;
+
+    gl_Position = position;
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#version 460 core
+
+uniform sampler2D u_Textures[16];
+
+layout(location = 0) in vec2 v_TexCoords;
+layout(location = 1) in vec4 v_Color;
+layout(location = 2) flat in int v_Texture;
+
+layout(location = 0) out vec4 FragColor;
+
+// The index can differ between neighbouring fragments, and indexing the
+// array with such a value is undefined, so every case uses a constant one.
+// The derivatives come from before any branch, where every fragment runs
+vec4 SampleTexture(int index, vec2 uv, vec2 dx, vec2 dy)
+{
+    switch(index) {
+        case 0:  return textureGrad(u_Textures[0], uv, dx, dy);
+        case 1:  return textureGrad(u_Textures[1], uv, dx, dy);
+        case 2:  return textureGrad(u_Textures[2], uv, dx, dy);
+        case 3:  return textureGrad(u_Textures[3], uv, dx, dy);
+        case 4:  return textureGrad(u_Textures[4], uv, dx, dy);
+        case 5:  return textureGrad(u_Textures[5], uv, dx, dy);
+        case 6:  return textureGrad(u_Textures[6], uv, dx, dy);
+        case 7:  return textureGrad(u_Textures[7], uv, dx, dy);
+        case 8:  return textureGrad(u_Textures[8], uv, dx, dy);
+        case 9:  return textureGrad(u_Textures[9], uv, dx, dy);
+        case 10: return textureGrad(u_Textures[10], uv, dx, dy);
+        case 11: return textureGrad(u_Textures[11], uv, dx, dy);
+        case 12: return textureGrad(u_Textures[12], uv, dx, dy);
+        case 13: return textureGrad(u_Textures[13], uv, dx, dy);
+        case 14: return textureGrad(u_Textures[14], uv, dx, dy);
+        case 15: return textureGrad(u_Textures[15], uv, dx, dy);
+    }
+    return vec4(1.0);
+}
+
+void main()
+{
+    vec2 dx = dFdx(v_TexCoords);
+    vec2 dy = dFdy(v_TexCoords);
+
+    vec4 color = v_Color;
+    if(v_Texture >= 0)
+        color *= SampleTexture(v_Texture, v_TexCoords, dx, dy);
+
+    if(color.a == 0.0)
+        discard;
+
+    FragColor = color;
+}
\ No newline at end of file
@@ -0,0 +1,22 @@
+#version 460 core
+
+uniform mat4 u_ViewProj;
+
+layout(location = 0) in vec3 a_Position;
+layout(location = 1) in vec2 a_TexCoords;
+layout(location = 2) in mat4 a_Transform;
+layout(location = 6) in vec4 a_Color;
+layout(location = 7) in float a_Texture;
+
+layout(location = 0) out vec2 v_TexCoords;
+layout(location = 1) out vec4 v_Color;
+layout(location = 2) flat out int v_Texture;
+
+void main()
+{
+    v_TexCoords = a_TexCoords;
+    v_Color = a_Color;
+    v_Texture = int(a_Texture);
+
+    gl_Position = u_ViewProj * a_Transform * vec4(a_Position, 1.0);
+}
\ No newline at end of file
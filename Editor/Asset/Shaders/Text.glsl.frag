@@ -0,0 +1,20 @@
+#version 460 core
+
+uniform sampler2D u_Atlas;
+
+layout(location = 0) in vec2 v_TexCoords;
+layout(location = 1) in vec4 v_Color;
+
+layout(location = 0) out vec4 FragColor;
+
+void main()
+{
+    // 0.5 is the outline, smoothed over about a pixel at any scale
+    float distance = texture(u_Atlas, v_TexCoords).r;
+    float width = fwidth(distance);
+    float alpha = smoothstep(0.5 - width, 0.5 + width, distance);
+    if(alpha == 0.0)
+        discard;
+
+    FragColor = vec4(v_Color.rgb, v_Color.a * alpha);
+}
\ No newline at end of file
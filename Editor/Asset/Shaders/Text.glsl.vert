@@ -0,0 +1,32 @@
+#version 460 core
+
+uniform mat4 u_ViewProj;
+
+const vec2 Corners[6] =
+    vec2[6](
+        vec2(0.0, 0.0),
+        vec2(1.0, 0.0),
+        vec2(1.0, 1.0),
+        vec2(1.0, 1.0),
+        vec2(0.0, 1.0),
+        vec2(0.0, 0.0)
+    );
+
+layout(location = 0) in mat4 a_Transform;
+layout(location = 4) in vec4 a_Rect;
+layout(location = 5) in vec4 a_UV;
+layout(location = 6) in vec4 a_Color;
+
+layout(location = 0) out vec2 v_TexCoords;
+layout(location = 1) out vec4 v_Color;
+
+void main()
+{
+    vec2 corner = Corners[gl_VertexID];
+    vec2 position = a_Rect.xy + corner * a_Rect.zw;
+
+    v_TexCoords = mix(a_UV.xy, a_UV.zw, corner);
+    v_Color = a_Color;
+
+    gl_Position = u_ViewProj * a_Transform * vec4(position, 0.0, 1.0);
+}
\ No newline at end of file
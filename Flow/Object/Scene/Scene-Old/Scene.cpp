@@ -60,14 +60,16 @@ void Scene::OnRender(SceneRenderer& renderer) {
 			renderer.SubmitParticles(Entity{ id });
 		});
 
+	List<Entity> meshes;
 	world.query_builder()
 	.with<MeshComponent>().and_().with<TransformComponent>()
 	.build()
 	.each(
 		[&](flecs::entity id)
 		{
-			renderer.SubmitMesh(Entity{ id });
+			meshes.Add(Entity{ id });
 		});
+	renderer.SubmitMeshes(meshes);
 
 	renderer.Render();
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <VolcaniCore/Core/Buffer.h>
+#include <Magma/Graphics/Renderer.h>
 #include <Magma/Graphics/RenderPass.h>
 #include <Magma/Graphics/Camera.h>
 #include <Magma/Graphics/CameraController.h>
@@ -28,6 +29,12 @@ public:
 	virtual void SubmitLight(const Entity& entity) = 0;
 	virtual void SubmitParticles(const Entity& entity) = 0;
 	virtual void SubmitMesh(const Entity& entity) = 0;
+	virtual void SubmitMeshes(const List<Entity>& entities) {
+		Graphics::Renderer::PushOptions(Graphics::RenderOptions::Mesh());
+		for(auto& entity : entities)
+			SubmitMesh(entity);
+		Graphics::Renderer::PopOptions();
+	}
 	virtual void Render() = 0;
 
 	Ref<Framebuffer> GetOutput() const { return m_Output; }
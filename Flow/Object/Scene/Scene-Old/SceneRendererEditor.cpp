@@ -10,6 +10,7 @@
 
 #include <VolcaniCore/Core/Application.h>
 #include <VolcaniCore/Core/Input.h>
+#include <Magma/Graphics/DebugDraw.h>
 #include <Magma/Graphics/Renderer.h>
 #include <Magma/Graphics/RendererAPI.h>
 #include <Magma/Graphics/Renderer2D.h>
@@ -20,6 +21,10 @@
 
 namespace Magma {
 
+// One per material asset and frame, so entities sharing a mesh and a
+// material are drawn together
+static Map<UUID, DrawCommand*> s_Materials;
+
 EditorSceneRenderer::EditorSceneRenderer() {
 	Application::PushDir();
 
@@ -58,7 +63,7 @@ EditorSceneRenderer::EditorSceneRenderer() {
 		.MaxVertexCount = 0,
 		.MaxInstanceCount = 152
 	};
-	BillboardBuffer = RendererAPI::Get()->NewDrawBuffer(specs);
+	BillboardBuffer = Renderer::GetAPI()->NewDrawBuffer(specs);
 
 	BillboardPass =
 		RenderPass::Create("Billboard",
@@ -115,7 +120,7 @@ EditorSceneRenderer::EditorSceneRenderer() {
 }
 
 EditorSceneRenderer::~EditorSceneRenderer() {
-	RendererAPI::Get()->ReleaseBuffer(BillboardBuffer);
+	Renderer::GetAPI()->ReleaseBuffer(BillboardBuffer);
 }
 
 void EditorSceneRenderer::Update(TimeStep ts) {
@@ -127,9 +132,8 @@ void EditorSceneRenderer::SetContext(SceneVisualizerPanel* panel) {
 	RootPanel = panel;
 	Renderer3D::End();
 	Renderer2D::End();
-	Renderer3D::GetMeshBuffer()->Clear();
 	// Renderer3D::GetCubemapBuffer()->Clear();
-	Renderer3D::GetLineBuffer()->Clear();
+	DebugDraw::Clear();
 }
 
 void EditorSceneRenderer::AddBillboard(const glm::vec3& pos, uint32_t type) {
@@ -154,15 +158,16 @@ void EditorSceneRenderer::AddBillboard(const glm::vec3& pos, uint32_t type) {
 
 void EditorSceneRenderer::Begin() {
 	auto camera = m_Controller.GetCamera();
+	Renderer3D::SetCamera(camera);
+	Renderer3D::AddCameraPass(MeshPass);
 
 	{
-		MeshCommand =
-			RendererAPI::Get()->NewDrawCommand(MeshPass->Get());
+		MeshCommand = Renderer::NewCommand(MeshPass);
 		MeshCommand->Clear = true;
 		MeshCommand->UniformData
-		.SetInput("u_ViewProj", camera->GetViewProjection());
+		.SetInput(Uniforms::ViewProj, camera->GetViewProjection());
 		MeshCommand->UniformData
-		.SetInput("u_CameraPosition", camera->GetPosition());
+		.SetInput(Uniforms::CameraPosition, camera->GetPosition());
 	}
 
 	BillboardBuffer->Clear(DrawBufferIndex::Instances);
@@ -176,13 +181,6 @@ void EditorSceneRenderer::Begin() {
 	// if(glm::intersectRayPlane(pos, dir, planePos, planeNormal, t))
 	// 	AddBillboard(pos + t * dir, 0);
 		AddBillboard(glm::vec3(0.0f), 0);
-
-	LineCommand = RendererAPI::Get()->NewDrawCommand(LinePass->Get());
-	LineCommand->DepthTest = DepthTestingMode::On;
-	LineCommand->Blending = BlendingMode::Greatest;
-	LineCommand->Culling = CullingMode::Off;
-	LineCommand->UniformData
-	.SetInput("u_ViewProj", m_Controller.GetCamera()->GetViewProjection());
 }
 
 void EditorSceneRenderer::SubmitCamera(const Entity& entity) {
@@ -196,60 +194,16 @@ void EditorSceneRenderer::SubmitCamera(const Entity& entity) {
 	if(Selected != entity)
 		return;
 
-	glm::mat4 inverse = glm::inverse(camera->GetViewProjection());
-
-	glm::vec4 p0 = inverse * glm::vec4(-1, -1, -1, 1); // Front bottom left
-	glm::vec4 p1 = inverse * glm::vec4( 1, -1, -1, 1); // Front bottom right
-	glm::vec4 p2 = inverse * glm::vec4( 1,  1, -1, 1); // Front top right
-	glm::vec4 p3 = inverse * glm::vec4(-1,  1, -1, 1); // Front top left
-	glm::vec4 p4 = inverse * glm::vec4(-1, -1,  1, 1); // Back bottom left
-	glm::vec4 p5 = inverse * glm::vec4( 1, -1,  1, 1); // Back bottom right
-	glm::vec4 p6 = inverse * glm::vec4( 1,  1,  1, 1); // Back top right
-	glm::vec4 p7 = inverse * glm::vec4(-1,  1,  1, 1); // Back top left
-
-	Point points[] =
-	{
-		{ p0 / p0.w, glm::vec3(1.0f) },
-		{ p1 / p1.w, glm::vec3(1.0f) },
-		{ p2 / p2.w, glm::vec3(1.0f) },
-		{ p3 / p3.w, glm::vec3(1.0f) },
-		{ p4 / p4.w, glm::vec3(1.0f) },
-		{ p5 / p5.w, glm::vec3(1.0f) },
-		{ p6 / p6.w, glm::vec3(1.0f) },
-		{ p7 / p7.w, glm::vec3(1.0f) },
-		{ camera->GetPosition(), glm::vec3(1.0f) }
-	};
-
-	constexpr uint32_t indexCount = 24;
-	uint32_t indices[indexCount] =
-	{
-		8, 7, // Left Top
-		8, 6, // Right Top
-		8, 4, // Left Bottom
-		8, 5, // Right Bottom
-
-		3, 2, // Front Top
-		0, 1, // Front Bottom
-		3, 0, // Front Left
-		2, 1, // Front Right
-
-		7, 6, // Back Top
-		4, 5, // Back Bottom
-		7, 4, // Back Left
-		6, 5, // Back Right
-	};
+	DebugDraw::Frustum(camera->GetViewProjection());
 
-	auto* buffer = LinePass->Get()->BufferData;
-	RendererAPI::Get()
-	->SetBufferData(buffer, DrawBufferIndex::Vertices, points, 9, 0);
-	RendererAPI::Get()
-	->SetBufferData(buffer, DrawBufferIndex::Indices, indices, indexCount);
-
-	auto& call = LineCommand->NewDrawCall();
-	call.VertexCount = 9;
-	call.IndexCount = indexCount;
-	call.Partition = PartitionType::Single;
-	call.Primitive = PrimitiveType::Line;
+	// From the camera out to the far corners
+	glm::mat4 inverse = glm::inverse(camera->GetViewProjection());
+	for(float x : { -1.0f, 1.0f })
+		for(float y : { -1.0f, 1.0f }) {
+			glm::vec4 corner = inverse * glm::vec4(x, y, 1.0f, 1.0f);
+			glm::vec3 end = glm::vec3(corner) / corner.w;
+			DebugDraw::Line(camera->GetPosition(), end);
+		}
 }
 
 void EditorSceneRenderer::SubmitSkybox(const Entity& entity) {
@@ -259,7 +213,7 @@ void EditorSceneRenderer::SubmitSkybox(const Entity& entity) {
 	auto cubemap = assetManager->Get<Cubemap>(sc.CubemapAsset);
 
 	MeshCommand->UniformData
-	.SetInput("u_Skybox", CubemapSlot{ cubemap });
+	.SetInput(Uniforms::Skybox, CubemapSlot{ cubemap });
 }
 
 void EditorSceneRenderer::SubmitLight(const Entity& entity) {
@@ -297,11 +251,13 @@ void EditorSceneRenderer::SubmitMesh(const Entity& entity) {
 
 	assetManager->Load(mc.MeshSourceAsset);
 	auto mesh = assetManager->Get<Mesh>(mc.MeshSourceAsset);
+	auto id = (uint64_t)entity.GetHandle();
 
+	// No empty command per entity, the batch brings its own
 	if(!mc.MaterialAsset.ID) {
-		Renderer::StartPass(MeshPass);
+		Renderer::StartPass(MeshPass, false);
 		{
-			Renderer3D::DrawMesh(mesh, tc);
+			Renderer3D::DrawMesh(mesh, tc, nullptr, id);
 		}
 		Renderer::EndPass();
 		return;
@@ -310,6 +266,11 @@ void EditorSceneRenderer::SubmitMesh(const Entity& entity) {
 	if(!assetManager->IsValid(mc.MaterialAsset))
 		return;
 
+	if(s_Materials.count(mc.MaterialAsset.ID)) {
+		Renderer3D::DrawMesh(mesh, tc, s_Materials[mc.MaterialAsset.ID], id);
+		return;
+	}
+
 	VolcaniCore::Material mat;
 	assetManager->Load(mc.MaterialAsset);
 	auto material = assetManager->Get<Magma::Material>(mc.MaterialAsset);
@@ -323,20 +284,21 @@ void EditorSceneRenderer::SubmitMesh(const Entity& entity) {
 	if(material->Vec4Uniforms.count("u_DiffuseColor"))
 		mat.DiffuseColor = material->Vec4Uniforms["u_DiffuseColor"];
 
-	DrawCommand* command =
-		RendererAPI::Get()->NewDrawCommand(MeshPass->Get());
+	DrawCommand* command = s_Materials[mc.MaterialAsset.ID] =
+		Renderer::NewMaterial(MeshPass);
 	command->UniformData
-	.SetInput("u_Material.IsTextured", (bool)mat.Diffuse);
+	.SetInput(Uniforms::MaterialIsTextured, (bool)mat.Diffuse);
 	command->UniformData
-	.SetInput("u_Material.Diffuse", TextureSlot{ mat.Diffuse, 0 });
+	.SetInput(Uniforms::MaterialDiffuse, TextureSlot{ mat.Diffuse, 0 });
 	command->UniformData
-	.SetInput("u_Material.DiffuseColor", mat.DiffuseColor);
+	.SetInput(Uniforms::MaterialDiffuseColor, mat.DiffuseColor);
 
-	Renderer3D::DrawMesh(mesh, tc, command);
+	Renderer3D::DrawMesh(mesh, tc, command, id);
 }
 
 void EditorSceneRenderer::Render() {
 	Renderer3D::End();
+	s_Materials.clear();
 
 	auto* assetManager = AssetManager::Get();
 	if(Selected && Selected.Has<TransformComponent>()
@@ -350,16 +312,16 @@ void EditorSceneRenderer::Render() {
 		auto mesh = assetManager->Get<Mesh>(mc.MeshSourceAsset);
 
 		{
-			auto* command =
-				RendererAPI::Get()->NewDrawCommand(MaskPass->Get());
+			auto* command = Renderer::NewCommand(MaskPass);
 			command->Clear = true;
 			command->UniformData
-			.SetInput("u_ViewProj",
-				MeshCommand->UniformData.Mat4Uniforms["u_ViewProj"]);
+			.SetInput(Uniforms::ViewProj,
+				m_Controller.GetCamera()->GetViewProjection());
 			command->UniformData
-			.SetInput("u_Color", glm::vec4(1.0f));
+			.SetInput(Uniforms::Color, glm::vec4(1.0f));
 
-			Renderer3D::DrawMesh(mesh, tc, command);
+			Renderer3D::DrawMesh(mesh, tc, command,
+								 (uint64_t)Selected.GetHandle());
 		}
 
 		Renderer::StartPass(OutlinePass);
@@ -369,9 +331,9 @@ void EditorSceneRenderer::Render() {
 
 			auto* command = Renderer::GetCommand();
 			command->UniformData
-			.SetInput("u_PixelSize", 1.0f / glm::vec2(width, height));
+			.SetInput(Uniforms::PixelSize, 1.0f / glm::vec2(width, height));
 			command->UniformData
-			.SetInput("u_Color", glm::vec3(0.0f, 0.0f, 1.0f));
+			.SetInput(Uniforms::Color, glm::vec3(0.0f, 0.0f, 1.0f));
 
 			auto mask = MaskPass->GetOutput();
 			Renderer2D::DrawFullscreenQuad(mask, AttachmentTarget::Color);
@@ -382,21 +344,23 @@ void EditorSceneRenderer::Render() {
 	Renderer3D::End();
 
 	auto camera = m_Controller.GetCamera();
+	Renderer::PushOptions(
+		{ DepthTestingMode::On, BlendingMode::Greatest, CullingMode::Off });
 	for(auto [pos, type] : Billboards) {
 		DrawCommand* command;
 		if(type == 0) {
-			command = RendererAPI::Get()->NewDrawCommand(GridPass->Get());
+			command = Renderer::NewCommand(GridPass);
 			command->UniformData
-			.SetInput("u_CameraPosition", camera->GetPosition());
+			.SetInput(Uniforms::CameraPosition, camera->GetPosition());
 		}
 		else {
-			command = RendererAPI::Get()->NewDrawCommand(BillboardPass->Get());
+			command = Renderer::NewCommand(BillboardPass);
 			command->UniformData
-			.SetInput("u_View", camera->GetView());
+			.SetInput(Uniforms::View, camera->GetView());
 			command->UniformData
-			.SetInput("u_BillboardWidth", 1.0f);
+			.SetInput(Uniforms::BillboardWidth, 1.0f);
 			command->UniformData
-			.SetInput("u_BillboardHeight", 1.0f);
+			.SetInput(Uniforms::BillboardHeight, 1.0f);
 			Ref<Texture> icon;
 			if(type == 1)
 				icon = CameraIcon;
@@ -410,14 +374,15 @@ void EditorSceneRenderer::Render() {
 				icon = ParticlesIcon;
 
 			command->UniformData
-			.SetInput("u_Texture", TextureSlot{ icon, 0 });
+			.SetInput(Uniforms::Texture, TextureSlot{ icon, 0 });
 		}
 
-		command->DepthTest = DepthTestingMode::On;
-		command->Blending = BlendingMode::Greatest;
-		command->Culling = CullingMode::Off;
 		command->UniformData
-		.SetInput("u_ViewProj", camera->GetViewProjection());
+		.SetInput(Uniforms::ViewProj, camera->GetViewProjection());
+
+		// Icons are blended, so the Renderer draws them back to front
+		float distance = glm::distance(camera->GetPosition(), pos);
+		Renderer::SetSortDepth(command, distance / camera->GetFar());
 
 		auto& call = command->NewDrawCall();
 		call.VertexCount = 6;
@@ -431,40 +396,18 @@ void EditorSceneRenderer::Render() {
 			BillboardBuffer->AddInstance(glm::value_ptr(pos));
 		}
 	}
+	Renderer::PopOptions();
 
 // #ifdef MAGMA_PHYSICS
 #if false
 	auto* scene = RootPanel->GetPhysicsWorld().Get();
 	const PxRenderBuffer& rb = scene->getRenderBuffer();
 	if(rb.getNbLines()) {
-		List<Point> points(rb.getNbLines() * 2);
-		List<uint32_t> indices(rb.getNbLines() * 2);
-	
 		for(uint32_t i = 0; i < rb.getNbLines(); i++) {
 			const PxDebugLine& l = rb.getLines()[i];
-			Point p0 = { { l.pos0.x, l.pos0.y, l.pos0.z }, glm::vec3(1.0f) };
-			Point p1 = { { l.pos1.x, l.pos1.y, l.pos1.z }, glm::vec3(1.0f) };
-			points.Add(p0);
-			points.Add(p1);
-			indices.Add(2*i);
-			indices.Add(2*i + 1);
+			DebugDraw::Line({ l.pos0.x, l.pos0.y, l.pos0.z },
+							{ l.pos1.x, l.pos1.y, l.pos1.z });
 		}
-
-		auto* buffer = LinePass->Get()->BufferData;
-		RendererAPI::Get()
-		->SetBufferData(buffer, DrawBufferIndex::Indices,
-			indices.GetBuffer().Get(), indices.Count(), 24);
-		RendererAPI::Get()
-		->SetBufferData(buffer, DrawBufferIndex::Vertices,
-			points.GetBuffer().Get(), points.Count(), 9);
-
-		auto& call = LineCommand->NewDrawCall();
-		call.IndexStart = 24;
-		call.IndexCount = indices.Count();
-		call.VertexStart = 9;
-		call.VertexCount = points.Count();
-		call.Partition = PartitionType::Single;
-		call.Primitive = PrimitiveType::Line;
 	}
 
 	// auto* editor = RootPanel->GetTab()
@@ -477,6 +420,8 @@ void EditorSceneRenderer::Render() {
 
 #endif
 
+	DebugDraw::Submit(LinePass, camera->GetViewProjection());
+
 	Renderer::Flush();
 
 	HasCamera = false;
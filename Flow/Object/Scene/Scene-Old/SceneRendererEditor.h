@@ -2,6 +2,10 @@
 
 #include <VolcaniCore/Core/Defines.h>
 
+#include <Magma/Graphics/CommandList.h>
+#include <Magma/Graphics/DynamicResolution.h>
+#include <Magma/Graphics/RenderGraph.h>
+
 #include <Magma/Scene/Scene.h>
 #include <Magma/Scene/SceneRenderer.h>
 
@@ -23,15 +27,32 @@ public:
 	void SubmitLight(const Entity& entity) override;
 	void SubmitParticles(const Entity& entity) override;
 	void SubmitMesh(const Entity& entity) override;
+	void SubmitMeshes(const List<Entity>& entities) override;
 	void Render() override;
 
 	void OnSceneLoad();
 	void OnSceneClose();
 
+	const RenderGraph& GetGraph() const { return Graph; }
+	DynamicResolution& GetResolution() { return Resolution; }
+
 private:
+	RenderGraph Graph;
+
 	// End
 	Ref<RenderPass> FinalCompositePass;
 
+	// Everything is drawn into the scene layer at the scaled resolution,
+	// then upscaled into the output
+	DynamicResolution Resolution;
+	Ref<Framebuffer> SceneLayer;
+	Ref<RenderPass> UpscalePass;
+
+	// Camera, kept so it never has to be read back out of a command
+	glm::mat4 View = glm::mat4(1.0f);
+	glm::mat4 ViewProj = glm::mat4(1.0f);
+	glm::vec3 CameraPosition = glm::vec3(0.0f);
+
 	// Lighting and shadows
 	Ref<RenderPass> DepthPass;
 	Ref<RenderPass> LightingPass;
@@ -48,7 +69,7 @@ private:
 	uint32_t PointLightCount = 0;
 	uint32_t SpotlightCount = 0;
 
-	// Bloom
+	// Bloom, the layers are owned by the graph and set every frame
 	Ref<Framebuffer> BaseLayer;
 	Ref<Framebuffer> Mips;
 	Ref<RenderPass> DownsamplePass;
@@ -61,7 +82,14 @@ private:
 	Ref<RenderPass> ParticlePass;
 
 private:
-	void InitMips();
+	// mesh is what to draw for the entity, the asset or its prepared copy
+	bool PrepareMesh(const Entity& entity, Ref<Mesh>& mesh,
+					 DrawCommand*& material);
+	void RecordMesh(const Entity& entity, Ref<Mesh> mesh,
+					DrawCommand* material, CommandList& list);
+
+	bool HasBloomLights() const;
+	void InitMips(const List<Ref<Texture>>& levels);
 	void Downsample();
 	void Upsample();
 	void Composite();
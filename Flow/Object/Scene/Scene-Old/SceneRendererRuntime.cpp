@@ -1,13 +1,18 @@
 #include "SceneRenderer.h"
 
+#include <mutex>
+
 #include <VolcaniCore/Core/Application.h>
+#include <VolcaniCore/Core/Log.h>
 
+#include <Magma/Graphics/MeshOptimizer.h>
 #include <Magma/Graphics/Renderer.h>
 #include <Magma/Graphics/RendererAPI.h>
 #include <Magma/Graphics/Renderer2D.h>
 #include <Magma/Graphics/Renderer3D.h>
 #include <Magma/Graphics/StereographicCamera.h>
 #include <Magma/Graphics/ShaderLibrary.h>
+#include <Magma/Graphics/WorkerPool.h>
 
 #include <Magma/Scene/Component.h>
 
@@ -101,8 +106,41 @@ static Map<uint64_t, ParticleEmitter> s_ParticleEmitters;
 
 static Map<UUID, DrawCommand*> s_MaterialMeshes;
 
+// Mesh assets are drawn as they are until an optimized copy with levels
+// and meshlets is built on the workers, then the copy is drawn instead
+struct PreparedMesh {
+	std::weak_ptr<Mesh> Source;
+	Ref<Mesh> Drawn;
+	Ref<MeshLOD> LODs;
+	Ref<MeshletSet> Meshlets;
+};
+
+static Map<UUID, PreparedMesh> s_PreparedMeshes;
+static List<std::pair<UUID, PreparedMesh>> s_FinishedMeshes;
+static std::mutex s_FinishedMutex;
+
+static Ref<WorkerPool> s_Workers;
+// Preparing a mesh can take seconds. It gets threads of its own, so the
+// jobs recording each frame never wait behind it, and few of them, so it
+// leaves most of the cores to the frame
+static Ref<WorkerPool> s_AssetWorkers;
+static List<Ref<CommandList>> s_CommandLists;
+static const uint64_t s_MinMeshesPerThread = 256;
+// Smaller meshes are drawn whole, instanced with their copies
+static const uint64_t s_MinMeshletTriangles = 8192;
+
 RuntimeSceneRenderer::RuntimeSceneRenderer() {
 	auto window = Application::GetWindow();
+
+	if(!s_Workers)
+		s_Workers = CreateRef<WorkerPool>();
+	if(!s_AssetWorkers)
+		s_AssetWorkers =
+			CreateRef<WorkerPool>(std::thread::hardware_concurrency() / 4);
+
+	uint32_t threadCount = s_Workers->GetThreadCount();
+	for(uint32_t i = s_CommandLists.Count(); i < threadCount; i++)
+		s_CommandLists.Add(CreateRef<CommandList>());
 	m_Output = Framebuffer::Create(window->GetWidth(), window->GetHeight());
 
 	DirectionalLightBuffer =
@@ -145,43 +183,38 @@ RuntimeSceneRenderer::RuntimeSceneRenderer() {
 				{ "_padding2", BufferDataType::Float },
 			}, 50);
 
+	Resolution.SetEnabled(true);
+
+	// Resized as the resolution scale changes, the passes drawing into it
+	// stay the same
+	SceneLayer = Framebuffer::Create(window->GetWidth(), window->GetHeight());
+
 	LightingPass =
 		RenderPass::Create("Lighting",
-			ShaderLibrary::Get("Lighting"), m_Output);
+			ShaderLibrary::Get("Lighting"), SceneLayer);
 	LightingPass->SetData(Renderer3D::GetMeshBuffer());
 
-	BaseLayer = Framebuffer::Create(window->GetWidth(), window->GetHeight());
-
-	LightPass =
-		RenderPass::Create("Light",
-			ShaderLibrary::Get("Light"), BaseLayer);
-	LightPass->SetData(Renderer2D::GetScreenBuffer());
-
-	InitMips();
-	DownsamplePass =
-		RenderPass::Create("Bloom-Downsample",
-			ShaderLibrary::Get("Bloom-Downsample"), Mips);
-	UpsamplePass =
-		RenderPass::Create("Bloom-Upsample",
-			ShaderLibrary::Get("Bloom-Upsample"), Mips);
 	BloomPass =
 		RenderPass::Create("Bloom",
-			ShaderLibrary::Get("Bloom"), m_Output);
-
-	DownsamplePass->SetData(Renderer2D::GetScreenBuffer());
-	UpsamplePass->SetData(Renderer2D::GetScreenBuffer());
+			ShaderLibrary::Get("Bloom"), SceneLayer);
 	BloomPass->SetData(Renderer2D::GetScreenBuffer());
 
+	ParticlePass =
+		RenderPass::Create("Particle-Draw",
+			ShaderLibrary::Get("Particle-DefaultDraw"), SceneLayer);
+	ParticlePass->SetData(Renderer3D::GetMeshBuffer());
+
+	UpscalePass =
+		RenderPass::Create("Upscale",
+			ShaderLibrary::Get("Framebuffer"), m_Output);
+	UpscalePass->SetData(Renderer2D::GetScreenBuffer());
+
 	EmitterPass =
 		RenderPass::Create("Particle-Emit",
 			ShaderLibrary::Get("Particle-Emit"));
 	UpdatePass =
 		RenderPass::Create("Particle-Update",
 			ShaderLibrary::Get("Particle-Update"));
-	ParticlePass =
-		RenderPass::Create("Particle-Draw",
-			ShaderLibrary::Get("Particle-DefaultDraw"), m_Output);
-	ParticlePass->SetData(Renderer3D::GetMeshBuffer());
 }
 
 void RuntimeSceneRenderer::OnSceneLoad() {
@@ -235,9 +268,12 @@ void RuntimeSceneRenderer::OnSceneLoad() {
 void RuntimeSceneRenderer::OnSceneClose() {
 	s_ParticleEmitters.clear();
 	s_MaterialMeshes.clear();
+	s_PreparedMeshes.clear();
 }
 
 void RuntimeSceneRenderer::Update(TimeStep ts) {
+	Renderer::PushScope("Particles");
+
 	Renderer::StartPass(EmitterPass);
 	{
 		int workGroupSize = 64;
@@ -293,32 +329,136 @@ void RuntimeSceneRenderer::Update(TimeStep ts) {
 		}
 	}
 	Renderer::EndPass();
-}
 
-void RuntimeSceneRenderer::Begin() {
-	LightCommand = RendererAPI::Get()->NewDrawCommand(LightPass->Get());
-	LightCommand->Clear = true;
-	LightCommand->DepthTest = DepthTestingMode::On;
-	LightCommand->Blending = BlendingMode::Greatest;
-	LightCommand->Culling = CullingMode::Off;
+	Renderer::PopScope();
+}
 
-	Renderer::StartPass(DownsamplePass, false);
+// Levels and meshlets only change between frames, before any list records
+static void PublishPreparedMeshes() {
+	List<std::pair<UUID, PreparedMesh>> finished;
 	{
-		Downsample();
+		std::lock_guard lock(s_FinishedMutex);
+		std::swap(finished, s_FinishedMeshes);
 	}
 
-	Renderer::StartPass(UpsamplePass, false);
-	{
-		Upsample();
+	for(auto& [id, result] : finished) {
+		// Built for an asset that was since closed or reloaded
+		auto found = s_PreparedMeshes.find(id);
+		auto source = result.Source.lock();
+		if(found == s_PreparedMeshes.end() || !source
+		|| found->second.Source.lock() != source)
+			continue;
+
+		Renderer3D::SetLODs(result.Drawn, result.LODs);
+		if(result.Meshlets)
+			Renderer3D::SetMeshlets(result.Drawn, result.Meshlets);
+		Renderer3D::ReleaseGeometry(source);
+		found->second = result;
 	}
-	Renderer::EndPass();
+}
 
-	Renderer::StartPass(BloomPass, false);
-	{
-		Composite();
-	}
+void RuntimeSceneRenderer::Begin() {
+	auto window = Application::GetWindow();
+	PublishPreparedMeshes();
+	Resolution.Update(Renderer::GetDebugInfo());
+	uint32_t width = Resolution.Scale(window->GetWidth());
+	uint32_t height = Resolution.Scale(window->GetHeight());
+	if(width != SceneLayer->GetWidth() || height != SceneLayer->GetHeight())
+		SceneLayer->Resize(width, height);
+
+	bool bloom = s_BloomStrength > 0.0f && HasBloomLights();
+
+	Graph.Clear();
+	auto scene = Graph.Import("Scene", SceneLayer);
+	auto base = Graph.Create("BaseLayer", { width, height });
+	auto mips = Graph.Create("Mips", { width, height, s_MipChainLength });
+	Graph.MarkOutput(scene);
+
+	Graph.AddPass("Light", { }, { base },
+		[=]()
+		{
+			BaseLayer = Graph.Get(base);
+			LightPass =
+				Graph.GetRenderPass("Light", ShaderLibrary::Get("Light"),
+					base, Renderer2D::GetScreenBuffer());
+
+			LightCommand = Renderer::NewCommand(LightPass);
+			LightCommand->Clear = true;
+			LightCommand->DepthTest = DepthTestingMode::On;
+			LightCommand->Blending = BlendingMode::Greatest;
+			LightCommand->Culling = CullingMode::Off;
+		});
+
+	Graph.AddPass("Bloom-Downsample", { base }, { mips },
+		[=]()
+		{
+			Mips = Graph.Get(mips);
+			InitMips(Graph.GetLevels(mips));
+			DownsamplePass =
+				Graph.GetRenderPass("Bloom-Downsample",
+					ShaderLibrary::Get("Bloom-Downsample"),
+					mips, Renderer2D::GetScreenBuffer());
+
+			Renderer::StartPass(DownsamplePass, false);
+			{
+				Downsample();
+			}
+		});
+
+	Graph.AddPass("Bloom-Upsample", { mips }, { mips },
+		[=]()
+		{
+			UpsamplePass =
+				Graph.GetRenderPass("Bloom-Upsample",
+					ShaderLibrary::Get("Bloom-Upsample"),
+					mips, Renderer2D::GetScreenBuffer());
+
+			Renderer::StartPass(UpsamplePass, false);
+			{
+				Upsample();
+			}
+			Renderer::EndPass();
+		});
+
+	// Without bloom the mip chain is never read, so the passes filling it
+	// are culled and its memory returns to the pool
+	List<RenderGraphResource> compositeInputs = { base };
+	if(bloom)
+		compositeInputs.Add(mips);
+	else
+		Mips = nullptr;
 
-	LightingCommand = RendererAPI::Get()->NewDrawCommand(LightingPass->Get());
+	Graph.AddPass("Bloom", compositeInputs, { scene },
+		[=]()
+		{
+			Renderer::StartPass(BloomPass, false);
+			{
+				Composite();
+			}
+		});
+
+	Graph.AddPass("Lighting", { }, { scene },
+		[=]()
+		{
+			LightingCommand = Renderer::NewCommand(LightingPass);
+		});
+
+	Renderer::PushScope("Graph");
+	Graph.Compile();
+	Graph.Execute();
+	Renderer::PopScope();
+}
+
+bool RuntimeSceneRenderer::HasBloomLights() const {
+	bool bloom = false;
+	App::Get()->GetScene()->EntityWorld
+	.ForEach<PointLightComponent>(
+		[&](Entity& entity)
+		{
+			bloom |= entity.Get<PointLightComponent>().Bloom;
+		});
+
+	return bloom;
 }
 
 void RuntimeSceneRenderer::SubmitCamera(const Entity& entity) {
@@ -326,12 +466,18 @@ void RuntimeSceneRenderer::SubmitCamera(const Entity& entity) {
 	if(!camera)
 		return;
 
+	Renderer3D::SetCamera(camera);
+	Renderer3D::AddCameraPass(LightingPass);
+	View = camera->GetView();
+	ViewProj = camera->GetViewProjection();
+	CameraPosition = camera->GetPosition();
+
 	LightingCommand->UniformData
-	.SetInput("u_View", camera->GetView());
+	.SetInput(Uniforms::View, View);
 	LightingCommand->UniformData
-	.SetInput("u_ViewProj", camera->GetViewProjection());
+	.SetInput(Uniforms::ViewProj, ViewProj);
 	LightingCommand->UniformData
-	.SetInput("u_CameraPosition", camera->GetPosition());
+	.SetInput(Uniforms::CameraPosition, CameraPosition);
 }
 
 void RuntimeSceneRenderer::SubmitSkybox(const Entity& entity) {
@@ -341,7 +487,7 @@ void RuntimeSceneRenderer::SubmitSkybox(const Entity& entity) {
 	auto cubemap = assetManager->Get<Cubemap>(sc.CubemapAsset);
 
 	LightingCommand->UniformData
-	.SetInput("u_Skybox", CubemapSlot{ cubemap, 0 });
+	.SetInput(Uniforms::Skybox, CubemapSlot{ cubemap, 0 });
 }
 
 void RuntimeSceneRenderer::SubmitLight(const Entity& entity) {
@@ -367,21 +513,19 @@ void RuntimeSceneRenderer::SubmitParticles(const Entity& entity) {
 	{
 		auto* command = Renderer::GetCommand();
 		command->UniformData
-		.SetInput("u_View",
-			LightingCommand->UniformData.Mat4Uniforms["u_View"]);
+		.SetInput(Uniforms::View, View);
 		command->UniformData
-		.SetInput("u_ViewProj",
-			LightingCommand->UniformData.Mat4Uniforms["u_ViewProj"]);
+		.SetInput(Uniforms::ViewProj, ViewProj);
 		command->UniformData
-		.SetInput("u_BillboardWidth", 0.1f);
+		.SetInput(Uniforms::BillboardWidth, 0.1f);
 		command->UniformData
-		.SetInput("u_BillboardHeight", 0.1f);
+		.SetInput(Uniforms::BillboardHeight, 0.1f);
 
 		command->DepthTest = DepthTestingMode::On;
 		command->Culling = CullingMode::Off;
 		command->Blending = BlendingMode::Greatest;
 		command->UniformData
-		.SetInput("u_Texture", TextureSlot{ emitter.Material, 0 });
+		.SetInput(Uniforms::Texture, TextureSlot{ emitter.Material, 0 });
 
 		auto& call = command->NewDrawCall();
 		call.VertexCount = 6;
@@ -392,28 +536,53 @@ void RuntimeSceneRenderer::SubmitParticles(const Entity& entity) {
 	Renderer::EndPass();
 }
 
-void RuntimeSceneRenderer::SubmitMesh(const Entity& entity) {
-	auto& tc = entity.Get<TransformComponent>();
+bool RuntimeSceneRenderer::PrepareMesh(const Entity& entity,
+									   Ref<Mesh>& mesh, DrawCommand*& command)
+{
 	auto& mc = entity.Get<MeshComponent>();
 	auto* assetManager = AssetManager::Get();
+	command = nullptr;
 
 	if(!assetManager->IsValid(mc.MeshSourceAsset))
-		return;
+		return false;
 
 	assetManager->Load(mc.MeshSourceAsset);
-	auto mesh = assetManager->Get<Mesh>(mc.MeshSourceAsset);
-
-	if(!mc.MaterialAsset.ID) {
-		Renderer::StartPass(LightingPass);
-		{
-			Renderer3D::DrawMesh(mesh, tc);
-		}
-		Renderer::EndPass();
-		return;
+	mesh = assetManager->Get<Mesh>(mc.MeshSourceAsset);
+
+	// Started once, the first time the mesh is drawn after it loads. The
+	// job works on a copy, the asset may change under it
+	auto& prepared = s_PreparedMeshes[mc.MeshSourceAsset.ID];
+	if(prepared.Source.lock() != mesh) {
+		prepared = { mesh };
+
+		UUID id = mc.MeshSourceAsset.ID;
+		PreparedMesh job = { mesh, CreateRef<Mesh>(*mesh) };
+		s_AssetWorkers->Post(
+			[id, job]() mutable
+			{
+				// Levels and meshlets keep the optimized order
+				MeshOptimizer::Optimize(job.Drawn);
+				job.LODs = CreateRef<MeshLOD>(job.Drawn);
+				if(job.LODs->GetLevel(0).Triangles >= s_MinMeshletTriangles)
+					job.Meshlets = CreateRef<MeshletSet>(job.Drawn);
+
+				std::lock_guard lock(s_FinishedMutex);
+				s_FinishedMeshes.Add({ id, job });
+			});
 	}
+	if(prepared.Drawn)
+		mesh = prepared.Drawn;
+
+	if(!mc.MaterialAsset.ID)
+		return true;
 
 	if(!assetManager->IsValid(mc.MaterialAsset))
-		return;
+		return false;
+
+	if(s_MaterialMeshes.count(mc.MaterialAsset.ID)) {
+		command = s_MaterialMeshes[mc.MaterialAsset.ID];
+		return true;
+	}
 
 	VolcaniCore::Material mat;
 	assetManager->Load(mc.MaterialAsset);
@@ -447,43 +616,113 @@ void RuntimeSceneRenderer::SubmitMesh(const Entity& entity) {
 	if(material->Vec4Uniforms.count("u_EmissiveColor"))
 		mat.EmissiveColor = material->Vec4Uniforms["u_EmissiveColor"];
 
+	command = s_MaterialMeshes[mc.MaterialAsset.ID] =
+		Renderer::NewMaterial(LightingPass);
 
-	DrawCommand* command;
-	if(!s_MaterialMeshes.count(mc.MaterialAsset.ID)) {
-		command = s_MaterialMeshes[mc.MaterialAsset.ID] =
-			RendererAPI::Get()->NewDrawCommand(LightingPass->Get());
+	command->UniformData
+	.SetInput(Uniforms::MaterialIsTextured, (bool)mat.Diffuse);
+	command->UniformData
+	.SetInput(Uniforms::MaterialDiffuse, TextureSlot{ mat.Diffuse, 0 });
+	command->UniformData
+	.SetInput(Uniforms::MaterialSpecular, TextureSlot{ mat.Specular, 1 });
+	command->UniformData
+	.SetInput(Uniforms::MaterialEmissive, TextureSlot{ mat.Emissive, 2 });
 
-		command->UniformData
-		.SetInput("u_Material.IsTextured", (bool)mat.Diffuse);
-		command->UniformData
-		.SetInput("u_Material.Diffuse", TextureSlot{ mat.Diffuse, 0 });
-		command->UniformData
-		.SetInput("u_Material.Specular", TextureSlot{ mat.Specular, 1 });
-		command->UniformData
-		.SetInput("u_Material.Emissive", TextureSlot{ mat.Emissive, 2 });
+	command->UniformData
+	.SetInput(Uniforms::MaterialDiffuseColor, mat.DiffuseColor);
+	command->UniformData
+	.SetInput(Uniforms::MaterialSpecularColor, mat.SpecularColor);
+	command->UniformData
+	.SetInput(Uniforms::MaterialEmissiveColor, mat.EmissiveColor);
 
-		command->UniformData
-		.SetInput("u_Material.DiffuseColor", mat.DiffuseColor);
-		command->UniformData
-		.SetInput("u_Material.SpecularColor", mat.SpecularColor);
-		command->UniformData
-		.SetInput("u_Material.EmissiveColor", mat.EmissiveColor);
+	return true;
+}
+
+void RuntimeSceneRenderer::RecordMesh(const Entity& entity, Ref<Mesh> mesh,
+									  DrawCommand* material, CommandList& list)
+{
+	Transform tc = entity.Get<TransformComponent>();
+	list.DrawMesh(mesh, tc.GetTransform(), material,
+				  (uint64_t)entity.GetHandle());
+}
+
+void RuntimeSceneRenderer::SubmitMesh(const Entity& entity) {
+	Ref<Mesh> mesh;
+	DrawCommand* material;
+	if(!PrepareMesh(entity, mesh, material))
+		return;
+
+	// No empty command per entity, the batch brings its own
+	if(!material) {
+		Renderer::StartPass(LightingPass, false);
+		{
+			RecordMesh(entity, mesh, nullptr, Renderer::GetCommandList());
+		}
+		Renderer::EndPass();
+		return;
+	}
+
+	RecordMesh(entity, mesh, material, Renderer::GetCommandList());
+}
+
+void RuntimeSceneRenderer::SubmitMeshes(const List<Entity>& entities) {
+	if(entities.Count() < s_MinMeshesPerThread * 2
+	|| s_CommandLists.Count() < 2)
+	{
+		SceneRenderer::SubmitMeshes(entities);
+		return;
+	}
+
+	// Asset loading and material setup stay on this thread,
+	// the workers only read what was prepared here
+	List<std::tuple<Entity, Ref<Mesh>, DrawCommand*>> meshes(entities.Count());
+	for(auto& entity : entities) {
+		Ref<Mesh> mesh;
+		DrawCommand* material;
+		if(PrepareMesh(entity, mesh, material))
+			meshes.Add({ entity, mesh, material });
 	}
 
-	command = s_MaterialMeshes[mc.MaterialAsset.ID];
+	uint64_t threadCount =
+		std::min<uint64_t>(s_CommandLists.Count(),
+						   meshes.Count() / s_MinMeshesPerThread + 1);
+	uint64_t chunkSize = (meshes.Count() + threadCount - 1) / threadCount;
+
+	auto options = RenderOptions::Mesh();
+	s_Workers->Run(threadCount,
+		[&](uint32_t t)
+		{
+			auto& list = *s_CommandLists[t];
+			list.Reset();
+			list.SetOptions(options);
+
+			uint64_t start = t * chunkSize;
+			uint64_t end = std::min<uint64_t>(start + chunkSize, meshes.Count());
+			for(uint64_t i = start; i < end; i++) {
+				auto& [entity, mesh, material] = meshes[i];
+				list.SetPass(material ? nullptr : LightingPass->Get());
+				RecordMesh(entity, mesh, material, list);
+			}
+
+			list.SetPass(nullptr);
+		});
 
-	Renderer3D::DrawMesh(mesh, tc, command);
+	// Merged in chunk order, so the result doesn't depend on which
+	// thread finished first. Their batches join the main list's, which
+	// uploads them all at once
+	for(uint64_t t = 0; t < threadCount; t++)
+		Renderer::Submit(*s_CommandLists[t]);
 }
 
 void RuntimeSceneRenderer::Render() {
 	Renderer3D::End();
 
 	LightingCommand->UniformData
-	.SetInput("u_DirectionalLightCount", (int32_t)HasDirectionalLight);
+	.SetInput(Uniforms::DirectionalLightCount, (int32_t)HasDirectionalLight);
 	LightingCommand->UniformData
-	.SetInput("u_PointLightCount", (int32_t)PointLightCount);
+	.SetInput(Uniforms::PointLightCount, (int32_t)PointLightCount);
 	LightingCommand->UniformData
-	.SetInput("u_SpotlightCount", (int32_t)SpotlightCount);
+	.SetInput(Uniforms::SpotlightCount, (int32_t)SpotlightCount);
 
 	LightingCommand->UniformData
 	.SetInput(UniformSlot{ DirectionalLightBuffer, "", 0 });
@@ -493,20 +732,17 @@ void RuntimeSceneRenderer::Render() {
 	.SetInput(UniformSlot{ SpotlightBuffer, "", 2 });
 
 	LightCommand->UniformData
-	.SetInput("u_View",
-		LightingCommand->UniformData.Mat4Uniforms["u_View"]);
+	.SetInput(Uniforms::View, View);
 	LightCommand->UniformData
-	.SetInput("u_ViewProj",
-		LightingCommand->UniformData.Mat4Uniforms["u_ViewProj"]);
+	.SetInput(Uniforms::ViewProj, ViewProj);
 	LightCommand->UniformData
 	.SetInput("u_Radius", 1.0f);
 	LightCommand->UniformData
-	.SetInput("u_CameraPosition",
-		LightingCommand->UniformData.Vec3Uniforms["u_CameraPosition"]);
+	.SetInput(Uniforms::CameraPosition, CameraPosition);
 	LightCommand->UniformData
-	.SetInput("u_ViewportWidth", (float)Application::GetWindow()->GetWidth());
+	.SetInput("u_ViewportWidth", (float)SceneLayer->GetWidth());
 	LightCommand->UniformData
-	.SetInput("u_ViewportHeight", (float)Application::GetWindow()->GetHeight());
+	.SetInput("u_ViewportHeight", (float)SceneLayer->GetHeight());
 	LightCommand->UniformData
 	.SetInput(UniformSlot{ PointLightBuffer, "", 1 });
 
@@ -517,6 +753,13 @@ void RuntimeSceneRenderer::Render() {
 	call.Primitive = PrimitiveType::Triangle;
 	call.Partition = PartitionType::Instanced;
 
+	Renderer::StartPass(UpscalePass);
+	{
+		Renderer::GetCommand()->Clear = true;
+		Renderer2D::DrawFullscreenQuad(SceneLayer, AttachmentTarget::Color);
+	}
+	Renderer::EndPass();
+
 	Renderer::Flush();
 
 	HasDirectionalLight = false;
@@ -526,34 +769,30 @@ void RuntimeSceneRenderer::Render() {
 	s_MaterialMeshes.clear();
 }
 
-void RuntimeSceneRenderer::InitMips() {
-	auto window = Application::GetWindow();
+void RuntimeSceneRenderer::InitMips(const List<Ref<Texture>>& levels) {
+	uint32_t width = BaseLayer->GetWidth();
+	uint32_t height = BaseLayer->GetHeight();
 
-	glm::vec2 mipSize((float)window->GetWidth(), (float)window->GetHeight());
-	glm::ivec2 mipIntSize(window->GetWidth(), window->GetHeight());
-	List<Ref<Texture>> textures;
-	for(uint32_t i = 0; i < s_MipChainLength; i++) {
+	glm::vec2 mipSize((float)width, (float)height);
+	glm::ivec2 mipIntSize(width, height);
+	s_MipChain.Clear();
+	for(auto& level : levels) {
 		BloomMip mip;
 
-		mipSize *= 0.5f;
-		mipIntSize /= 2;
+		mipSize = glm::max(mipSize * 0.5f, glm::vec2(1.0f));
+		mipIntSize = glm::max(mipIntSize / 2, glm::ivec2(1));
 		mip.Size = mipSize;
 		mip.IntSize = mipIntSize;
-
-		mip.Sampler =
-			Texture::Create(mipIntSize.x, mipIntSize.y, Texture::Format::Float);
+		mip.Sampler = level;
 
 		s_MipChain.Add(mip);
-		textures.Add(mip.Sampler);
 	}
-
-	Mips = Framebuffer::Create(
-		{
-			{ AttachmentTarget::Color, textures }
-		});
 }
 
 void RuntimeSceneRenderer::Downsample() {
+	Renderer::PushOptions(
+		{ DepthTestingMode::Off, BlendingMode::Off, CullingMode::Off });
+
 	auto* command = Renderer::NewCommand();
 	command->Clear = true;
 	command->UniformData
@@ -567,9 +806,6 @@ void RuntimeSceneRenderer::Downsample() {
 	for(const auto& mip : s_MipChain) {
 		command->ViewportWidth = mip.IntSize.x;
 		command->ViewportHeight = mip.IntSize.y;
-		command->DepthTest = DepthTestingMode::Off;
-		command->Blending = BlendingMode::Off;
-		command->Culling = CullingMode::Off;
 		command->Outputs = { { AttachmentTarget::Color, i++ } };
 
 		auto& call = command->NewDrawCall();
@@ -583,9 +819,14 @@ void RuntimeSceneRenderer::Downsample() {
 		command->UniformData
 		.SetInput("u_SrcTexture", TextureSlot{ mip.Sampler, 0 });
 	}
+
+	Renderer::PopOptions();
 }
 
 void RuntimeSceneRenderer::Upsample() {
+	Renderer::PushOptions(
+		{ DepthTestingMode::Off, BlendingMode::Additive, CullingMode::Off });
+
 	auto* command = Renderer::NewCommand();
 	command->UniformData
 	.SetInput("u_FilterRadius", s_FilterRadius);
@@ -596,9 +837,6 @@ void RuntimeSceneRenderer::Upsample() {
 
 		command->ViewportWidth = nextMip.IntSize.x;
 		command->ViewportHeight = nextMip.IntSize.y;
-		command->DepthTest = DepthTestingMode::Off;
-		command->Blending = BlendingMode::Additive;
-		command->Culling = CullingMode::Off;
 		command->Outputs = { { AttachmentTarget::Color, i - 1 } };
 		command->UniformData
 		.SetInput("u_SrcTexture", TextureSlot{ mip.Sampler, 0 });
@@ -612,24 +850,28 @@ void RuntimeSceneRenderer::Upsample() {
 
 		command = Renderer::NewCommand();
 	}
+
+	Renderer::PopOptions();
 }
 
 void RuntimeSceneRenderer::Composite() {
 	auto* command = Renderer::NewCommand();
 	command->Clear = true;
-	command->ViewportWidth = Application::GetWindow()->GetWidth();
-	command->ViewportHeight = Application::GetWindow()->GetHeight();
+	command->ViewportWidth = SceneLayer->GetWidth();
+	command->ViewportHeight = SceneLayer->GetHeight();
 	command->DepthTest = DepthTestingMode::Off;
 	command->Blending = BlendingMode::Greatest;
 	command->Culling = CullingMode::Off;
 
 	command->UniformData
 	.SetInput("u_Exposure", s_Exposure);
+	// The scene layer stands in for the bloom texture when bloom is off
+	auto bloom = Mips ? Mips : BaseLayer;
 	command->UniformData
-	.SetInput("u_BloomStrength", s_BloomStrength);
+	.SetInput("u_BloomStrength", Mips ? s_BloomStrength : 0.0f);
 	command->UniformData
 	.SetInput("u_BloomTexture",
-		TextureSlot{ Mips->Get(AttachmentTarget::Color), 0 });
+		TextureSlot{ bloom->Get(AttachmentTarget::Color), 0 });
 	command->UniformData
 	.SetInput("u_SceneTexture",
 		TextureSlot{ BaseLayer->Get(AttachmentTarget::Color), 1 });
@@ -361,14 +361,44 @@ void SceneVisualizerPanel::Draw() {
 		ImGui::SetCursorPos(pos);
 
 		auto childFlags = ImGuiChildFlags_Border;
-		ImGui::BeginChild("Debug", { 135, 120 }, childFlags, 0);
+		auto info = Renderer::GetDebugInfo();
+		float height =
+			252 + 17 * (info.Passes.Count() + info.LODTriangles.Count());
+		ImGui::BeginChild("Debug", { 220, height }, childFlags, 0);
 		{
-			auto info = Renderer::GetDebugInfo();
 			ImGui::Text("FPS: %0.1f", info.FPS);
+			ImGui::Text("Frame: %0.2f ms", info.FrameTime);
+			ImGui::Text("Flush: %0.2f ms", info.FlushTime);
 			ImGui::Text("Draw Calls: %li", info.DrawCalls);
 			ImGui::Text("Indices: %li", info.Indices);
 			ImGui::Text("Vertices: %li", info.Vertices);
 			ImGui::Text("Instances: %li", info.Instances);
+			ImGui::Text("Instances/Call: %0.1f",
+				info.DrawCalls ? (float)info.Instances / info.DrawCalls : 0.0f);
+			ImGui::Text("State Changes: %li (%li redundant)",
+				info.StateChanges, info.RedundantStates);
+			ImGui::Text("Bindings: %li (%li unsorted)",
+				info.BindingsSorted, info.BindingsUnsorted);
+			ImGui::Text("Commands: %li new, %li reused",
+				info.CommandsCreated, info.CommandsReused);
+			for(uint64_t i = 0; i < info.LODTriangles.Count(); i++)
+				ImGui::Text("LOD %li: %li triangles", i, info.LODTriangles[i]);
+			ImGui::Text("Meshlet Triangles Culled: %0.1f%%",
+				info.MeshletTriangles
+				? 100.0f * info.MeshletTrianglesCulled / info.MeshletTriangles
+				: 0.0f);
+
+			ImGui::Separator();
+			for(auto& pass : info.Passes) {
+				ImGui::Indent(8.0f * (pass.Depth + 1));
+				if(pass.GPUTime < 0.0f)
+					ImGui::Text("%s: %0.2f ms, %li", pass.Name.c_str(),
+						pass.CPUTime, pass.DrawCalls);
+				else
+					ImGui::Text("%s: %0.2f/%0.2f ms, %li", pass.Name.c_str(),
+						pass.CPUTime, pass.GPUTime, pass.DrawCalls);
+				ImGui::Unindent(8.0f * (pass.Depth + 1));
+			}
 		}
 		ImGui::EndChild();
 
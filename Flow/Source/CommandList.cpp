@@ -0,0 +1,533 @@
+#include "CommandList.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "RendererAPI.h"
+#include "Renderer.h"
+#include "Renderer3D.h"
+
+using namespace VolcaniCore;
+
+namespace Magma::Graphics {
+
+CommandList::LODMap CommandList::s_PreviousLODs;
+
+RenderOptions RenderOptions::Default() {
+	static const DrawCommand command{ };
+	return { command.DepthTest, command.Blending, command.Culling };
+}
+
+RecordedCommand* CommandList::AcquireCommand() {
+	if(m_PoolUsed == m_Pool.size()) {
+		m_Pool.emplace_back();
+		m_CommandsCreated++;
+		return &m_Pool[m_PoolUsed++];
+	}
+
+	// Starts over, keeping what its calls grew into
+	auto& command = m_Pool[m_PoolUsed++];
+	auto calls = std::move(command.Calls);
+	calls.Clear();
+	command = { };
+	command.Calls = std::move(calls);
+	m_CommandsReused++;
+	return &command;
+}
+
+DrawCommand* CommandList::NewCommand(DrawPass* pass) {
+	auto* command = AcquireCommand();
+	command->Pass = pass;
+	command->DepthTest = m_Options.DepthTest;
+	command->Blending = m_Options.Blending;
+	command->Culling = m_Options.Culling;
+	m_Commands.Add(command);
+	return command;
+}
+
+DrawCommand* CommandList::NewMaterial(DrawPass* pass) {
+	auto* command = m_Arena.New<RecordedCommand>();
+	command->Pass = pass;
+	return command;
+}
+
+void CommandList::SetSortMaterial(DrawCommand* command, uint64_t material) {
+	auto* recorded = static_cast<RecordedCommand*>(command);
+	recorded->Material = material;
+}
+
+void CommandList::SetSortDepth(DrawCommand* command, float depth) {
+	auto* recorded = static_cast<RecordedCommand*>(command);
+	recorded->Depth = glm::min(recorded->Depth, depth);
+}
+
+void CommandList::DrawMesh(Ref<Mesh> mesh, const glm::mat4& tr,
+						   DrawCommand* command, uint64_t instance)
+{
+	auto lods = Renderer3D::GetLODs(mesh.get());
+	uint32_t level = lods ? SelectLOD(mesh.get(), instance, *lods, tr) : 0;
+	if(level) {
+		auto& lod = lods->GetLevel(level);
+		for(auto& subMesh : lod.SubMeshes)
+			DrawSubMesh(mesh, subMesh, tr, command);
+
+		AddLODTriangles(level, lod.Triangles);
+		return;
+	}
+
+	uint64_t triangles = 0;
+	for(auto& subMesh : mesh->SubMeshes)
+		triangles += subMesh.Indices.Count() / 3;
+	AddLODTriangles(0, triangles);
+
+	// Only resident geometry can be drawn in parts
+	DrawPass* pass = command ? command->Pass : m_Pass;
+	auto meshlets = Renderer3D::GetMeshlets(mesh.get());
+	if(meshlets && Renderer3D::GetCamera() && Renderer3D::IsCameraPass(pass)
+	&& pass->BufferData == Renderer3D::GetMeshBuffer())
+	{
+		DrawMeshlets(mesh, *meshlets, tr, command);
+		return;
+	}
+
+	for(auto& subMesh : mesh->SubMeshes)
+		DrawSubMesh(mesh, subMesh, tr, command);
+}
+
+void CommandList::DrawMeshlets(Ref<Mesh> root, const MeshletSet& meshlets,
+							   const glm::mat4& tr, DrawCommand* cmd)
+{
+	DrawPass* pass = cmd ? cmd->Pass : m_Pass;
+	auto camera = Renderer3D::GetCamera();
+	Frustum frustum(camera->GetViewProjection());
+
+	// Instances wholly on one side of the frustum aren't split up, those
+	// inside stay instanced with their copies
+	float scale =
+		glm::max(glm::length(glm::vec3(tr[0])),
+				 glm::max(glm::length(glm::vec3(tr[1])),
+						  glm::length(glm::vec3(tr[2]))));
+	glm::vec3 center = tr * glm::vec4(meshlets.GetCenter(), 1.0f);
+	float radius = meshlets.GetRadius() * scale;
+
+	MeshletCullStats whole;
+	whole.Meshlets = meshlets.GetMeshletCount();
+	whole.Triangles = meshlets.GetTriangleCount();
+	if(!frustum.Intersects(center, radius)) {
+		whole.Culled = whole.Meshlets;
+		whole.CulledTriangles = whole.Triangles;
+		m_MeshletStats += whole;
+		return;
+	}
+	if(frustum.Contains(center, radius)) {
+		m_MeshletStats += whole;
+		for(auto& subMesh : root->SubMeshes)
+			DrawSubMesh(root, subMesh, tr, cmd);
+		return;
+	}
+
+	for(uint64_t i = 0; i < root->SubMeshes.Count(); i++) {
+		auto& subMesh = root->SubMeshes[i];
+		m_Ranges.Clear();
+		m_MeshletStats +=
+			MeshletSet::Cull(meshlets.GetMeshlets(i), tr, frustum,
+							 camera->GetPosition(), m_Ranges);
+
+		// Triangles left out of every meshlet are always drawn
+		uint32_t end = 0;
+		if(meshlets.GetMeshlets(i))
+			end = meshlets.GetMeshlets(i)[-1].IndexStart
+				+ meshlets.GetMeshlets(i)[-1].IndexCount;
+		if(end < subMesh.Indices.Count())
+			m_Ranges.Add({ end, uint32_t(subMesh.Indices.Count() - end) });
+
+		for(auto& range : m_Ranges)
+			DrawSubMeshRange(root, subMesh, pass, cmd, tr, range);
+	}
+}
+
+uint32_t CommandList::SelectLOD(Mesh* mesh, uint64_t instance,
+								const MeshLOD& lods, const glm::mat4& tr)
+{
+	auto camera = Renderer3D::GetCamera();
+	if(!camera)
+		return 0;
+
+	float scale =
+		glm::max(glm::length(glm::vec3(tr[0])),
+				 glm::max(glm::length(glm::vec3(tr[1])),
+						  glm::length(glm::vec3(tr[2]))));
+
+	// Pixels one mesh unit covers. Perspective divides by the distance to
+	// the nearest point of the bounds, orthographic doesn't
+	const glm::mat4& projection = camera->GetProjection();
+	float pixelsPerUnit =
+		projection[1][1] * camera->GetViewportHeight() * 0.5f * scale;
+	if(projection[2][3] != 0.0f) {
+		glm::vec3 center = tr * glm::vec4(lods.GetCenter(), 1.0f);
+		float distance = glm::distance(camera->GetPosition(), center)
+					   - lods.GetRadius() * scale;
+		pixelsPerUnit /= glm::max(distance, camera->GetNear());
+	}
+
+	if(!instance)
+		instance = (1ull << 63) | m_UnnamedLODs[mesh]++;
+
+	LODKey key{ mesh, instance };
+	int32_t previous = -1;
+	auto found = s_PreviousLODs.find(key);
+	if(found != s_PreviousLODs.end())
+		previous = found->second;
+
+	uint32_t level =
+		lods.Select(pixelsPerUnit, Renderer3D::GetLODError(), previous);
+	m_LODs[key] = (uint8_t)level;
+	return level;
+}
+
+void CommandList::AddLODTriangles(uint32_t level, uint64_t count) {
+	while(m_LODTriangles.Count() <= level)
+		m_LODTriangles.Add(0);
+	m_LODTriangles[level] += count;
+}
+
+DrawCommand* CommandList::GetDrawCommand(Ref<Mesh> root, SubMesh& mesh,
+										 DrawPass* pass, DrawCommand* cmd)
+{
+	// A material is either the command given to DrawMesh or one of the
+	// mesh's own
+	const void* material = cmd;
+	if(!cmd && root->Materials)
+		material = &root->Materials[mesh.MaterialIndex];
+
+	auto* command = static_cast<RecordedCommand*>(NewCommand(pass));
+	command->Batched = true;
+	SetSortMaterial(command, (uint64_t)material);
+	if(cmd)
+		command->UniformData = cmd->UniformData;
+
+	if(!command->UniformData && root->Materials)
+		command->UniformData = GetMaterialUniforms(root, mesh.MaterialIndex);
+	return command;
+}
+
+void CommandList::DrawSubMesh(Ref<Mesh> root, SubMesh& mesh,
+							  const glm::mat4& tr, DrawCommand* cmd)
+{
+	DrawPass* pass = cmd ? cmd->Pass : m_Pass;
+	if(!pass)
+		return;
+
+	AddInstances(root, mesh, pass, cmd, &tr, 1);
+}
+
+void CommandList::AddInstances(Ref<Mesh> root, SubMesh& mesh, DrawPass* pass,
+							   DrawCommand* cmd, const glm::mat4* transforms,
+							   uint64_t count)
+{
+	auto* batch = &m_Meshes[{ &mesh, pass, cmd }];
+	if(!batch->Command) {
+		auto* command = GetDrawCommand(root, mesh, pass, cmd);
+		uint64_t index = command->Calls.Count();
+		m_Geometry
+		.Add({ command, index, m_Instances.Count(), root, &mesh, pass, cmd,
+			   0, 0 });
+
+		// Its place in the instance buffer is only known once every
+		// instance has been gathered
+		auto& call = command->NewDrawCall();
+		call.Primitive = PrimitiveType::Triangle;
+		call.Partition = PartitionType::Instanced;
+
+		batch->Command = command;
+		batch->Call = index;
+		batch->Block = m_Instances.Count();
+		m_Instances
+		.Add({ command->Pass->BufferData, { }, command, index });
+	}
+
+	auto* command = batch->Command;
+	auto& block = m_Instances[batch->Block];
+	for(uint64_t i = 0; i < count; i++) {
+		SortByDistance(command, transforms[i]);
+		block.Transforms.Add(transforms[i]);
+	}
+
+	command->Calls[batch->Call].InstanceCount += count;
+}
+
+// The ranges differ from instance to instance, so every one gets a
+// command of its own
+void CommandList::DrawSubMeshRange(Ref<Mesh> root, SubMesh& mesh,
+								   DrawPass* pass, DrawCommand* cmd,
+								   const glm::mat4& tr,
+								   const MeshletRange& range)
+{
+	auto* command = GetDrawCommand(root, mesh, pass, cmd);
+	uint64_t index = command->Calls.Count();
+	m_Geometry
+	.Add({ command, index, m_Instances.Count(), root, &mesh, pass, cmd,
+		   range.IndexStart, range.IndexCount });
+
+	auto& call = command->NewDrawCall();
+	call.Primitive = PrimitiveType::Triangle;
+	call.Partition = PartitionType::Instanced;
+	call.InstanceCount = 1;
+
+	m_Instances
+	.Add({ command->Pass->BufferData, { }, command, index });
+	m_Instances[-1].Transforms.Add(tr);
+
+	SortByDistance(command, tr);
+}
+
+void CommandList::SortByDistance(DrawCommand* command, const glm::mat4& tr) {
+	auto camera = Renderer3D::GetCamera();
+	if(!camera)
+		return;
+
+	glm::vec3 position = tr[3];
+	float distance = glm::distance(camera->GetPosition(), position);
+	SetSortDepth(command, distance / camera->GetFar());
+}
+
+static bool SameMaterial(const Material& a, const Material& b) {
+	return a.Diffuse == b.Diffuse && a.Specular == b.Specular
+		&& a.Emissive == b.Emissive && a.DiffuseColor == b.DiffuseColor
+		&& a.SpecularColor == b.SpecularColor
+		&& a.EmissiveColor == b.EmissiveColor;
+}
+
+const UniformData& CommandList::GetMaterialUniforms(Ref<Mesh> root,
+													uint32_t index)
+{
+	// A mesh made where one that is gone used to be starts over
+	auto& entry = m_Materials[root.get()];
+	if(entry.Owner.lock() != root) {
+		entry.Owner = root;
+		entry.Materials.Clear();
+	}
+	while(entry.Materials.Count() <= index)
+		entry.Materials.Add({ });
+
+	const Material& mat = root->Materials[index];
+	auto& cached = entry.Materials[index];
+	if(cached.Built && SameMaterial(cached.Source, mat))
+		return cached.Data;
+
+	cached.Source = mat;
+	cached.Built = true;
+
+	auto& data = cached.Data;
+	data = { };
+	data.SetInput(Uniforms::MaterialIsTextured, (bool)mat.Diffuse);
+	data.SetInput(Uniforms::MaterialDiffuse, TextureSlot{ mat.Diffuse, 0 });
+	data.SetInput(Uniforms::MaterialSpecular, TextureSlot{ mat.Specular, 1 });
+	data.SetInput(Uniforms::MaterialEmissive, TextureSlot{ mat.Emissive, 2 });
+	data.SetInput(Uniforms::MaterialDiffuseColor, mat.DiffuseColor);
+	data.SetInput(Uniforms::MaterialSpecularColor, mat.SpecularColor);
+	data.SetInput(Uniforms::MaterialEmissiveColor, mat.EmissiveColor);
+	return data;
+}
+
+void CommandList::ClearBatches() {
+	m_Meshes.clear();
+}
+
+void CommandList::Upload() {
+	auto* meshBuffer = Renderer3D::GetMeshBuffer();
+	for(auto& geometry : m_Geometry) {
+		auto* command = geometry.Command;
+		auto* buffer = command->Pass->BufferData;
+
+		// Other buffers are filled again every frame
+		if(buffer != meshBuffer) {
+			if(geometry.Material) {
+				command->IndicesIndex = buffer->IndicesCount;
+				command->VerticesIndex = buffer->VerticesCount;
+			}
+
+			command->AddIndices(geometry.Mesh->Indices);
+			command->AddVertices(geometry.Mesh->Vertices);
+			continue;
+		}
+
+		// Dropped for this frame when the mesh buffer is full
+		auto& call = command->Calls[geometry.Call];
+		auto* range = Renderer3D::GetGeometry(geometry.Root, *geometry.Mesh);
+		if(!range) {
+			call.InstanceCount = 0;
+			continue;
+		}
+
+		call.IndexStart = range->IndexStart + geometry.IndexStart;
+		call.IndexCount =
+			geometry.IndexCount ? geometry.IndexCount : range->IndexCount;
+		call.VertexStart = range->VertexStart;
+		call.VertexCount = range->VertexCount;
+		m_Instances[geometry.Block].Dequantize = range->Dequantize;
+	}
+
+	// Every batch gets exactly as many slots as it has instances, packed
+	// one after another. Mesh buffer instances are encoded straight into
+	// its ring and go up in one upload when the Renderer flushes, other
+	// buffers get one full matrix upload per batch. The uniform scale flag
+	// holds for a command only when it holds for all of its calls
+	Map<DrawCommand*, bool> uniformScales;
+	for(auto& block : m_Instances) {
+		auto* command = block.Command;
+		auto& call = command->Calls[block.Call];
+		if(!call.InstanceCount)
+			continue;
+
+		auto* data = block.Transforms.GetBuffer().Get();
+		uint64_t count = block.Transforms.Count();
+		auto format = InstanceFormat::Matrix;
+		auto vertexFormat = VertexFormat::Float;
+		bool uniformScale;
+		if(block.Buffer != meshBuffer) {
+			call.InstanceStart = block.Buffer->InstancesCount;
+			Renderer::GetAPI()
+			->SetBufferData(block.Buffer, DrawBufferIndex::Instances,
+							data, count, call.InstanceStart);
+
+			uniformScale = true;
+			for(uint64_t i = 0; i < count; i++)
+				uniformScale &= Instances::HasUniformScale(data[i]);
+		}
+		else {
+			format = Renderer3D::GetInstanceFormat();
+			vertexFormat = Renderer3D::GetVertexFormat();
+			call.InstanceStart = Renderer3D::ReserveInstances(count);
+			void* out = Renderer3D::StageInstances(call.InstanceStart, count);
+			if(!out) {
+				call.InstanceCount = 0;
+				continue;
+			}
+
+			// Quantized positions go back to mesh units along with the
+			// instance transform, the scale being uniform
+			const glm::vec4& dequantize = block.Dequantize;
+			if(dequantize != glm::vec4(0.0f, 0.0f, 0.0f, 1.0f)) {
+				glm::mat4 tr =
+					glm::translate(glm::mat4(1.0f), glm::vec3(dequantize))
+				  * glm::scale(glm::mat4(1.0f), glm::vec3(dequantize.w));
+				for(uint64_t i = 0; i < count; i++)
+					data[i] = data[i] * tr;
+			}
+
+			uniformScale = Instances::Encode(format, data, count, out);
+		}
+
+		command->UniformData
+		.SetInput(Uniforms::InstanceFormat, (int32_t)format);
+		command->UniformData
+		.SetInput(Uniforms::VertexFormat, (int32_t)vertexFormat);
+
+		if(uniformScales.count(command))
+			uniformScales[command] &= uniformScale;
+		else
+			uniformScales[command] = uniformScale;
+	}
+
+	for(auto& [command, uniformScale] : uniformScales)
+		command->UniformData
+		.SetInput(Uniforms::UniformScale, uniformScale);
+
+	// The ranges are gone, batches can't keep growing into them
+	m_Meshes.clear();
+	m_Geometry.Clear();
+	m_Instances.Clear();
+}
+
+void CommandList::Append(CommandList& list) {
+	// The list's blocks come with their transforms and sort depth already
+	// worked out. A whole submesh joins the batch this list has for it,
+	// anything else brings its command and block along
+	for(auto geometry : list.m_Geometry) {
+		auto& block = list.m_Instances[geometry.Block];
+		auto* command = static_cast<RecordedCommand*>(geometry.Command);
+		uint64_t count = block.Transforms.Count();
+
+		MeshBatch* batch = nullptr;
+		if(!geometry.IndexCount) {
+			batch = &m_Meshes[{ geometry.Mesh, geometry.Pass,
+								geometry.Material }];
+			if(batch->Command) {
+				auto& transforms = m_Instances[batch->Block].Transforms;
+				for(uint64_t i = 0; i < count; i++)
+					transforms.Add(block.Transforms[i]);
+
+				batch->Command->Calls[batch->Call].InstanceCount += count;
+				SetSortDepth(batch->Command, command->Depth);
+				continue;
+			}
+		}
+
+		geometry.Block = m_Instances.Count();
+		if(batch)
+			*batch = { command, geometry.Call, geometry.Block };
+		m_Instances.Add(std::move(block));
+		m_Geometry.Add(geometry);
+		m_Commands.Add(command);
+	}
+
+	// Batch commands merged into this list's stay behind in the list's
+	// arena, unused
+	for(auto* command : list.m_Commands)
+		if(!command->Batched)
+			m_Commands.Add(command);
+	list.m_Commands.Clear();
+	list.m_Meshes.clear();
+	list.m_Geometry.Clear();
+	list.m_Instances.Clear();
+
+	for(auto& [key, level] : list.m_LODs)
+		m_LODs[key] = level;
+	list.m_LODs.clear();
+
+	for(uint64_t i = 0; i < list.m_LODTriangles.Count(); i++)
+		AddLODTriangles(i, list.m_LODTriangles[i]);
+	list.m_LODTriangles.Clear();
+	m_MeshletStats += list.m_MeshletStats;
+	list.m_MeshletStats = { };
+	m_CommandsCreated += list.m_CommandsCreated;
+	m_CommandsReused += list.m_CommandsReused;
+	list.m_CommandsCreated = 0;
+	list.m_CommandsReused = 0;
+}
+
+void CommandList::ClearCommands() {
+	m_Commands.Clear();
+}
+
+void CommandList::PublishLODs() {
+	// Instances not drawn this frame are forgotten
+	s_PreviousLODs.swap(m_LODs);
+	m_LODs.clear();
+}
+
+void CommandList::Reset() {
+	m_Commands.Clear();
+	m_Meshes.clear();
+	m_Geometry.Clear();
+	m_Instances.Clear();
+	m_Pass = nullptr;
+	m_Arena.Reset();
+	m_PoolUsed = 0;
+	m_CommandsCreated = 0;
+	m_CommandsReused = 0;
+
+	m_LODs.clear();
+	m_UnnamedLODs.clear();
+	m_LODTriangles.Clear();
+	m_MeshletStats = { };
+
+	for(auto it = m_Materials.begin(); it != m_Materials.end(); ) {
+		if(it->second.Owner.expired())
+			it = m_Materials.erase(it);
+		else
+			it++;
+	}
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,253 @@
+#pragma once
+
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+#include <VolcaniCore/Core/Defines.h>
+#include <VolcaniCore/Core/Math.h>
+
+#include "Graphics/RendererAPI.h"
+#include "Graphics/Mesh.h"
+
+#include "FrameArena.h"
+#include "MeshLOD.h"
+#include "Meshlet.h"
+#include "UniformID.h"
+
+using namespace VolcaniCore;
+
+namespace Magma::Graphics {
+
+// The fixed-function state a command starts with
+struct RenderOptions {
+	DepthTestingMode DepthTest;
+	BlendingMode Blending;
+	CullingMode Culling;
+
+	// What a DrawCommand starts with
+	static RenderOptions Default();
+	// Depth tested, opaque and back-face culled
+	static RenderOptions Mesh() {
+		return { DepthTestingMode::On, BlendingMode::Off, CullingMode::Back };
+	}
+
+	bool operator ==(const RenderOptions& other) const {
+		return DepthTest == other.DepthTest && Blending == other.Blending
+			&& Culling == other.Culling;
+	}
+	bool operator !=(const RenderOptions& other) const {
+		return !(*this == other);
+	}
+};
+
+// What the Renderer needs to know about a command on top of what the
+// backend consumes
+struct RecordedCommand : public DrawCommand {
+	uint64_t Material = 0; // Anything naming the material, 0 for none
+	float Depth = 1.0f;
+	// Only carries mesh batches, which Append merges into the batches of
+	// the list it is appended to
+	bool Batched = false;
+};
+
+// A list of commands that can be recorded on any thread. Nothing here
+// touches the backend until Upload(), which must run on the render thread,
+// so several lists can record in parallel and be merged with
+// Renderer::Submit(). Only the list everything is merged into is uploaded.
+class CommandList {
+public:
+	CommandList() = default;
+	~CommandList() = default;
+
+	CommandList(const CommandList&) = delete;
+	CommandList& operator =(const CommandList&) = delete;
+
+	// Commands start with the options set here. Lists recorded on other
+	// threads should copy Renderer::GetOptions() before recording
+	DrawCommand* NewCommand(DrawPass* pass);
+	void SetOptions(const RenderOptions& options) { m_Options = options; }
+	const RenderOptions& GetOptions() const { return m_Options; }
+
+	// Carries uniforms for DrawMesh to copy, it is never drawn itself.
+	// Lives until the end of the frame
+	DrawCommand* NewMaterial(DrawPass* pass);
+
+	// Draws of a submesh with the same pass and material are merged into
+	// one instanced call. The material comes from the command given to
+	// DrawMesh, or from the mesh without one. So does the pass, or it
+	// comes from SetPass
+	void SetPass(DrawPass* pass) { m_Pass = pass; }
+	DrawPass* GetPass() const { return m_Pass; }
+
+	// Meshes with LODs are drawn at the level picked for this instance.
+	// instance tells the draws of a mesh apart across frames and lists,
+	// an entity's ID for one. Without it, an instance is known by how many
+	// such draws of its mesh came before it in the list, so hysteresis
+	// holds as long as that order does
+	void DrawMesh(Ref<Mesh> mesh, const glm::mat4& tr,
+				  DrawCommand* command = nullptr, uint64_t instance = 0);
+	void ClearBatches();
+
+	// Writes staged geometry and instances to the backend
+	void Upload();
+
+	// Takes the commands of the list. Its mesh draws join the batches of
+	// this one, so instances recorded on different threads share calls
+	void Append(CommandList& list);
+	void ClearCommands();
+	void Reset();
+	// The levels picked since the last Reset, appended lists included, are
+	// the ones hysteresis holds to in every list from now on. Render
+	// thread only, while no list records
+	void PublishLODs();
+
+	List<RecordedCommand*>& GetCommands() { return m_Commands; }
+	// Triangles drawn at each level of detail since the last Reset,
+	// including those of appended lists. Meshes without LODs are level 0
+	const List<uint64_t>& GetLODTriangles() const { return m_LODTriangles; }
+	// Meshlets tested since the last Reset, appended lists included
+	const MeshletCullStats& GetMeshletStats() const { return m_MeshletStats; }
+	// Commands handed out since the last Reset, appended lists included,
+	// that had to be made, and ones reused from an earlier frame
+	uint64_t GetCommandsCreated() const { return m_CommandsCreated; }
+	uint64_t GetCommandsReused() const { return m_CommandsReused; }
+	FrameArena& GetArena() { return m_Arena; }
+
+	static void SetSortMaterial(DrawCommand* command, uint64_t material);
+	static void SetSortDepth(DrawCommand* command, float depth);
+
+private:
+	struct Geometry {
+		DrawCommand* Command;
+		uint64_t Call;
+		uint64_t Block;
+		Ref<Mesh> Root;
+		SubMesh* Mesh;
+		// As given to DrawMesh, for Append to draw it again
+		DrawPass* Pass;
+		DrawCommand* Material;
+		// Part of the indices, all of them when IndexCount is 0
+		uint32_t IndexStart;
+		uint32_t IndexCount;
+	};
+
+	struct InstanceBlock {
+		DrawBuffer* Buffer;
+		List<glm::mat4> Transforms;
+
+		DrawCommand* Command;
+		uint64_t Call;
+
+		// Set from the geometry, see GeometryRange
+		glm::vec4 Dequantize = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	};
+
+	struct MeshBatch {
+		DrawCommand* Command = nullptr;
+		uint64_t Call = 0;
+		uint64_t Block = 0;
+	};
+
+	// Unnamed instances have the top bit set
+	struct LODKey {
+		Mesh* Root;
+		uint64_t Instance;
+
+		bool operator ==(const LODKey& other) const {
+			return Root == other.Root && Instance == other.Instance;
+		}
+	};
+
+	struct LODKeyHash {
+		size_t operator ()(const LODKey& key) const {
+			size_t hash = std::hash<void*>()(key.Root);
+			hash ^= std::hash<uint64_t>()(key.Instance)
+				  + 0x9e3779b9 + (hash << 6);
+			return hash;
+		}
+	};
+
+	using LODMap = std::unordered_map<LODKey, uint8_t, LODKeyHash>;
+
+	struct BatchKey {
+		SubMesh* Mesh;
+		DrawPass* Pass;
+		DrawCommand* Material;
+
+		bool operator ==(const BatchKey& other) const {
+			return Mesh == other.Mesh && Pass == other.Pass
+				&& Material == other.Material;
+		}
+	};
+
+	struct BatchKeyHash {
+		size_t operator ()(const BatchKey& key) const {
+			size_t hash = std::hash<void*>()(key.Mesh);
+			hash ^= std::hash<void*>()(key.Pass) + 0x9e3779b9 + (hash << 6);
+			hash ^= std::hash<void*>()(key.Material) + 0x9e3779b9 + (hash << 6);
+			return hash;
+		}
+	};
+
+	struct MaterialUniforms {
+		Material Source;
+		UniformData Data;
+		bool Built = false;
+	};
+
+	struct MeshMaterials {
+		std::weak_ptr<Mesh> Owner;
+		List<MaterialUniforms> Materials;
+	};
+
+	FrameArena m_Arena;
+	List<RecordedCommand*> m_Commands;
+	// Outlive frames along with the storage of their calls, Reset hands
+	// them out again from the start
+	std::deque<RecordedCommand> m_Pool;
+	uint64_t m_PoolUsed = 0;
+	uint64_t m_CommandsCreated = 0;
+	uint64_t m_CommandsReused = 0;
+	DrawPass* m_Pass = nullptr;
+	RenderOptions m_Options = RenderOptions::Default();
+
+	std::unordered_map<BatchKey, MeshBatch, BatchKeyHash> m_Meshes;
+	List<Geometry> m_Geometry;
+	List<InstanceBlock> m_Instances;
+	LODMap m_LODs; // Picked since the last Reset
+	Map<Mesh*, uint64_t> m_UnnamedLODs;
+	List<uint64_t> m_LODTriangles;
+	List<MeshletRange> m_Ranges;
+	MeshletCullStats m_MeshletStats;
+
+	// Outlives frames, a material's uniforms are only rebuilt when it
+	// changes. Reset drops the materials of meshes that are gone, and the
+	// textures with them
+	Map<const Mesh*, MeshMaterials> m_Materials;
+
+	// Last published, only read while lists record
+	static LODMap s_PreviousLODs;
+
+private:
+	RecordedCommand* AcquireCommand();
+	void DrawSubMesh(Ref<Mesh> root, SubMesh& mesh, const glm::mat4& tr,
+					 DrawCommand* cmd);
+	void AddInstances(Ref<Mesh> root, SubMesh& mesh, DrawPass* pass,
+					  DrawCommand* cmd, const glm::mat4* transforms,
+					  uint64_t count);
+	void DrawMeshlets(Ref<Mesh> root, const MeshletSet& meshlets,
+					  const glm::mat4& tr, DrawCommand* cmd);
+	void DrawSubMeshRange(Ref<Mesh> root, SubMesh& mesh, DrawPass* pass,
+						  DrawCommand* cmd, const glm::mat4& tr,
+						  const MeshletRange& range);
+	void SortByDistance(DrawCommand* command, const glm::mat4& tr);
+	uint32_t SelectLOD(Mesh* mesh, uint64_t instance, const MeshLOD& lods,
+					   const glm::mat4& tr);
+	void AddLODTriangles(uint32_t level, uint64_t count);
+	DrawCommand* GetDrawCommand(Ref<Mesh> root, SubMesh& mesh,
+								DrawPass* pass, DrawCommand* cmd);
+	const UniformData& GetMaterialUniforms(Ref<Mesh> root, uint32_t index);
+};
+
+}
\ No newline at end of file
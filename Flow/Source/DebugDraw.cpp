@@ -0,0 +1,259 @@
+#include "DebugDraw.h"
+
+#include <vector>
+
+#include <glm/gtc/constants.hpp>
+
+#include <VolcaniCore/Core/Log.h>
+
+#include "Renderer.h"
+#include "RendererAPI.h"
+#include "UniformID.h"
+
+using namespace VolcaniCore;
+
+namespace Magma::Graphics {
+
+const uint32_t DebugDraw::CircleSegments = 24;
+
+static Ref<GrowableBuffer> s_Buffer;
+
+// One line list per mode, two vertices per line
+static std::vector<DebugVertex> s_Vertices[2];
+
+// Corners of the unit cube, then the pairs making its twelve edges
+static const glm::vec3 s_Corners[8] =
+{
+	{ -0.5f, -0.5f, -0.5f }, {  0.5f, -0.5f, -0.5f },
+	{  0.5f,  0.5f, -0.5f }, { -0.5f,  0.5f, -0.5f },
+	{ -0.5f, -0.5f,  0.5f }, {  0.5f, -0.5f,  0.5f },
+	{  0.5f,  0.5f,  0.5f }, { -0.5f,  0.5f,  0.5f }
+};
+
+static const uint32_t s_Edges[24] =
+{
+	0, 1, 1, 2, 2, 3, 3, 0,
+	4, 5, 5, 6, 6, 7, 7, 4,
+	0, 4, 1, 5, 2, 6, 3, 7
+};
+
+static std::vector<DebugVertex>& GetVertices(DebugDrawMode mode) {
+	return s_Vertices[(uint32_t)mode];
+}
+
+// Writes the edges of a box with the given corners
+static void AddEdges(const glm::vec3* corners, const glm::vec3& color,
+					 DebugDrawMode mode)
+{
+	auto& vertices = GetVertices(mode);
+	for(uint32_t i = 0; i < 24; i++)
+		vertices.push_back({ corners[s_Edges[i]], color });
+}
+
+void DebugDraw::Init() {
+	BufferLayout layout =
+		{
+			{
+				{ "Position", BufferDataType::Vec3 },
+				{ "Color",    BufferDataType::Vec3 },
+			},
+			true, // Dynamic
+			false // Instanced
+		};
+
+	DrawBufferSpecification specs
+	{
+		layout,
+		{ },
+		0,
+		32 * 1024,
+		0
+	};
+
+	s_Buffer = CreateRef<GrowableBuffer>("Line", specs);
+}
+
+void DebugDraw::Close() {
+	s_Buffer.reset();
+	Clear();
+}
+
+void DebugDraw::StartFrame() {
+	s_Buffer->Resize();
+	s_Buffer->Get()->Clear();
+	// Lines no pass submitted last frame don't carry over
+	Clear();
+}
+
+DrawBuffer* DebugDraw::GetBuffer() {
+	return s_Buffer->Get();
+}
+
+uint64_t DebugDraw::GetLineCount(DebugDrawMode mode) {
+	return GetVertices(mode).size() / 2;
+}
+
+void DebugDraw::Clear() {
+	s_Vertices[0].clear();
+	s_Vertices[1].clear();
+}
+
+void DebugDraw::Line(const glm::vec3& p0, const glm::vec3& p1,
+					 const glm::vec3& color, DebugDrawMode mode)
+{
+	auto& vertices = GetVertices(mode);
+	vertices.push_back({ p0, color });
+	vertices.push_back({ p1, color });
+}
+
+void DebugDraw::Lines(const Graphics::Line* lines, uint64_t count,
+					  DebugDrawMode mode)
+{
+	auto& vertices = GetVertices(mode);
+	vertices.reserve(vertices.size() + count * 2);
+	for(uint64_t i = 0; i < count; i++) {
+		vertices.push_back({ lines[i].P0.Position, lines[i].P0.Color });
+		vertices.push_back({ lines[i].P1.Position, lines[i].P1.Color });
+	}
+}
+
+void DebugDraw::Lines(const DebugVertex* vertices, uint64_t count,
+					  DebugDrawMode mode)
+{
+	auto& list = GetVertices(mode);
+	list.insert(list.end(), vertices, vertices + count - count % 2);
+}
+
+void DebugDraw::Polyline(const glm::vec3* points, uint64_t count,
+						 const glm::vec3& color, bool closed,
+						 DebugDrawMode mode)
+{
+	if(count < 2)
+		return;
+
+	auto& vertices = GetVertices(mode);
+	vertices.reserve(vertices.size() + count * 2);
+	for(uint64_t i = 0; i + 1 < count; i++) {
+		vertices.push_back({ points[i], color });
+		vertices.push_back({ points[i + 1], color });
+	}
+
+	if(closed) {
+		vertices.push_back({ points[count - 1], color });
+		vertices.push_back({ points[0], color });
+	}
+}
+
+void DebugDraw::Box(const glm::vec3& min, const glm::vec3& max,
+					const glm::vec3& color, DebugDrawMode mode)
+{
+	glm::vec3 corners[8];
+	for(uint32_t i = 0; i < 8; i++)
+		corners[i] = (min + max) * 0.5f + s_Corners[i] * (max - min);
+	AddEdges(corners, color, mode);
+}
+
+void DebugDraw::Boxes(const glm::mat4* transforms, uint64_t count,
+					  const glm::vec3& color, DebugDrawMode mode)
+{
+	GetVertices(mode).reserve(GetVertices(mode).size() + count * 24);
+
+	glm::vec3 corners[8];
+	for(uint64_t i = 0; i < count; i++) {
+		for(uint32_t j = 0; j < 8; j++)
+			corners[j] = transforms[i] * glm::vec4(s_Corners[j], 1.0f);
+		AddEdges(corners, color, mode);
+	}
+}
+
+void DebugDraw::Sphere(const glm::vec3& center, float radius,
+					   const glm::vec3& color, DebugDrawMode mode)
+{
+	glm::vec4 sphere = glm::vec4(center, radius);
+	Spheres(&sphere, 1, color, mode);
+}
+
+void DebugDraw::Spheres(const glm::vec4* spheres, uint64_t count,
+						const glm::vec3& color, DebugDrawMode mode)
+{
+	// The unit circle is the same for every sphere
+	static List<glm::vec2> s_Circle;
+	if(!s_Circle)
+		for(uint32_t i = 0; i <= CircleSegments; i++) {
+			float angle = glm::two_pi<float>() * i / CircleSegments;
+			s_Circle.Add({ glm::cos(angle), glm::sin(angle) });
+		}
+
+	auto& vertices = GetVertices(mode);
+	vertices.reserve(vertices.size() + count * CircleSegments * 6);
+
+	for(uint64_t i = 0; i < count; i++) {
+		glm::vec3 center = spheres[i];
+		float radius = spheres[i].w;
+
+		for(uint32_t j = 0; j < CircleSegments; j++) {
+			glm::vec2 a = s_Circle[j] * radius;
+			glm::vec2 b = s_Circle[j + 1] * radius;
+
+			vertices.push_back({ center + glm::vec3(a.x, a.y, 0.0f), color });
+			vertices.push_back({ center + glm::vec3(b.x, b.y, 0.0f), color });
+			vertices.push_back({ center + glm::vec3(a.x, 0.0f, a.y), color });
+			vertices.push_back({ center + glm::vec3(b.x, 0.0f, b.y), color });
+			vertices.push_back({ center + glm::vec3(0.0f, a.x, a.y), color });
+			vertices.push_back({ center + glm::vec3(0.0f, b.x, b.y), color });
+		}
+	}
+}
+
+void DebugDraw::Frustum(const glm::mat4& viewProj, const glm::vec3& color,
+						DebugDrawMode mode)
+{
+	// The corners of clip space, back to where the camera sees them
+	glm::mat4 inverse = glm::inverse(viewProj);
+	glm::vec3 corners[8];
+	for(uint32_t i = 0; i < 8; i++) {
+		glm::vec4 corner = inverse * glm::vec4(s_Corners[i] * 2.0f, 1.0f);
+		corners[i] = glm::vec3(corner) / corner.w;
+	}
+
+	AddEdges(corners, color, mode);
+}
+
+void DebugDraw::Submit(Ref<RenderPass> pass, const glm::mat4& viewProj) {
+	auto* buffer = s_Buffer->Get();
+
+	for(uint32_t i = 0; i < 2; i++) {
+		auto& vertices = s_Vertices[i];
+		uint64_t count = vertices.size();
+		if(!count)
+			continue;
+
+		// Dropped for this frame when the buffer is full
+		if(!s_Buffer->Request(DrawBufferIndex::Vertices, count)) {
+			vertices.clear();
+			continue;
+		}
+
+		uint64_t start = buffer->VerticesCount;
+		Renderer::GetAPI()
+		->SetBufferData(buffer, DrawBufferIndex::Vertices, vertices.data(),
+						count, start);
+		vertices.clear();
+
+		auto* command = Renderer::NewCommand(pass);
+		command->DepthTest =
+			(DebugDrawMode)i == DebugDrawMode::Overlay ? DepthTestingMode::Off
+													   : DepthTestingMode::On;
+		command->Blending = BlendingMode::Greatest;
+		command->Culling = CullingMode::Off;
+		command->UniformData.SetInput(Uniforms::ViewProj, viewProj);
+
+		auto& call = command->NewDrawCall();
+		call.VertexStart = start;
+		call.VertexCount = count;
+		call.Primitive = PrimitiveType::Line;
+		call.Partition = PartitionType::Single;
+	}
+}
+
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <VolcaniCore/Core/Defines.h>
+#include <VolcaniCore/Core/Math.h>
+
+#include "Graphics/RendererAPI.h"
+#include "Graphics/RenderPass.h"
+#include "Graphics/Line.h"
+
+#include "GrowableBuffer.h"
+
+using namespace VolcaniCore;
+
+namespace Magma::Graphics {
+
+enum class DebugDrawMode : uint8_t {
+	DepthTested,
+	Overlay // Drawn over everything
+};
+
+struct DebugVertex {
+	glm::vec3 Position;
+	glm::vec3 Color;
+};
+
+// Lines gathered over a frame and drawn with one call per mode. Shapes are
+// expanded into line lists straight into a staging array that goes up with
+// a single upload per mode, there are no indices. Render thread only.
+class DebugDraw {
+public:
+	static void Line(const glm::vec3& p0, const glm::vec3& p1,
+					 const glm::vec3& color = glm::vec3(1.0f),
+					 DebugDrawMode mode = DebugDrawMode::DepthTested);
+	static void Lines(const Graphics::Line* lines, uint64_t count,
+					  DebugDrawMode mode = DebugDrawMode::DepthTested);
+	// Pairs of vertices
+	static void Lines(const DebugVertex* vertices, uint64_t count,
+					  DebugDrawMode mode = DebugDrawMode::DepthTested);
+
+	static void Polyline(const glm::vec3* points, uint64_t count,
+						 const glm::vec3& color = glm::vec3(1.0f),
+						 bool closed = false,
+						 DebugDrawMode mode = DebugDrawMode::DepthTested);
+
+	static void Box(const glm::vec3& min, const glm::vec3& max,
+					const glm::vec3& color = glm::vec3(1.0f),
+					DebugDrawMode mode = DebugDrawMode::DepthTested);
+	// Unit cubes centered on the origin, then transformed
+	static void Boxes(const glm::mat4* transforms, uint64_t count,
+					  const glm::vec3& color = glm::vec3(1.0f),
+					  DebugDrawMode mode = DebugDrawMode::DepthTested);
+
+	// Three circles, one around each axis
+	static void Sphere(const glm::vec3& center, float radius,
+					   const glm::vec3& color = glm::vec3(1.0f),
+					   DebugDrawMode mode = DebugDrawMode::DepthTested);
+	// Center in xyz, radius in w
+	static void Spheres(const glm::vec4* spheres, uint64_t count,
+						const glm::vec3& color = glm::vec3(1.0f),
+						DebugDrawMode mode = DebugDrawMode::DepthTested);
+
+	// The volume a view projection matrix sees
+	static void Frustum(const glm::mat4& viewProj,
+						const glm::vec3& color = glm::vec3(1.0f),
+						DebugDrawMode mode = DebugDrawMode::DepthTested);
+
+	// Draws everything gathered with the pass, then starts over. The pass
+	// must draw from GetBuffer(). Lines not submitted by the end of the frame
+	// are dropped
+	static void Submit(Ref<RenderPass> pass, const glm::mat4& viewProj);
+
+	static DrawBuffer* GetBuffer();
+	static uint64_t GetLineCount(DebugDrawMode mode);
+	static void Clear();
+
+	// Segments per circle of a sphere
+	static const uint32_t CircleSegments;
+
+private:
+	static void Init();
+	static void Close();
+	static void StartFrame();
+
+	friend class Renderer3D;
+};
+
+}
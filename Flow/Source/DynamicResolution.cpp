@@ -0,0 +1,112 @@
+#include "DynamicResolution.h"
+
+#include <cmath>
+
+#include <glm/glm.hpp>
+
+using namespace VolcaniCore;
+
+namespace Magma::Graphics {
+
+// Share of the frame period the CPU's own work takes in a CPU bound frame
+static const float s_CPUBound = 0.9f;
+// Most averaging windows between two tries of a step up
+static const uint32_t s_MaxProbeDelay = 16;
+
+DynamicResolution::DynamicResolution(
+	const DynamicResolutionSpecification& specs)
+	: m_Specs(specs), m_Scale(specs.MaxScale) { }
+
+void DynamicResolution::Update(const FrameDebugInfo& info) {
+	if(!m_Enabled)
+		return;
+
+	bool timed = info.GPUTime >= 0.0f;
+	float time = timed ? info.GPUTime : info.FramePeriod;
+	if(time <= 0.0f)
+		return;
+
+	m_Total += time;
+	if(!timed)
+		m_CPUTotal += info.FrameTime - info.FlushTime;
+	if(++m_Count < m_Specs.Frames)
+		return;
+
+	float average = m_Total / m_Count;
+	float cpu = m_CPUTotal / m_Count;
+	m_Total = 0.0f;
+	m_CPUTotal = 0.0f;
+	m_Count = 0;
+
+	// The frame limiter holds frames to its period, which is on target
+	float target = m_Specs.TargetFrameTime;
+	if(Renderer::GetFrameLimit() > 0.0f)
+		target = glm::max(target, 1000.0f / Renderer::GetFrameLimit());
+
+	// Close enough, moving would only make the scale oscillate. A display
+	// or limiter holds the period to the target however much time the GPU
+	// has left, so without timings a step up is tried now and then
+	if(std::abs(average - target) < target * 0.05f) {
+		m_Probed = false;
+		if(!timed)
+			Probe();
+		return;
+	}
+	if(average > target && cpu > average * s_CPUBound)
+		return;
+
+	// The step up didn't fit, so back to where it was, and the next try
+	// waits twice as long
+	if(m_Probed && average > target) {
+		m_Probed = false;
+		m_Scale = glm::max(m_Scale - m_Specs.Step, m_Specs.MinScale);
+		m_ProbeDelay = glm::min(m_ProbeDelay * 2, s_MaxProbeDelay);
+		m_ProbeWait = m_ProbeDelay;
+		return;
+	}
+	m_Probed = false;
+	m_ProbeDelay = 1;
+
+	// Down at least one step when too slow, up only as far as is safe
+	float scale = m_Scale * std::sqrt(target / average) / m_Specs.Step;
+	scale = average > target ? std::floor(scale) : std::round(scale);
+	m_Scale =
+		glm::clamp(scale * m_Specs.Step, m_Specs.MinScale, m_Specs.MaxScale);
+}
+
+void DynamicResolution::SetEnabled(bool enabled) {
+	m_Enabled = enabled;
+	m_Scale = m_Specs.MaxScale;
+	m_Total = 0.0f;
+	m_CPUTotal = 0.0f;
+	m_Count = 0;
+	m_Probed = false;
+	m_ProbeDelay = 1;
+	m_ProbeWait = 0;
+}
+
+void DynamicResolution::Probe() {
+	if(m_Scale >= m_Specs.MaxScale)
+		return;
+	if(m_ProbeWait) {
+		m_ProbeWait--;
+		return;
+	}
+
+	m_Scale = glm::min(m_Scale + m_Specs.Step, m_Specs.MaxScale);
+	m_Probed = true;
+	m_ProbeWait = m_ProbeDelay;
+}
+
+void DynamicResolution::SetSpecification(
+	const DynamicResolutionSpecification& specs)
+{
+	m_Specs = specs;
+	m_Scale = glm::clamp(m_Scale, m_Specs.MinScale, m_Specs.MaxScale);
+}
+
+uint32_t DynamicResolution::Scale(uint32_t size) const {
+	return glm::max(uint32_t(size * m_Scale + 0.5f), 1u);
+}
+
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <VolcaniCore/Core/Defines.h>
+
+#include "Renderer.h"
+
+using namespace VolcaniCore;
+
+namespace Magma::Graphics {
+
+struct DynamicResolutionSpecification {
+	float TargetFrameTime = 1000.0f / 60.0f; // Milliseconds
+	float MinScale = 0.5f;
+	float MaxScale = 1.0f;
+	// Scales are kept to multiples of this, so targets sized from them
+	// change rarely and can be reused
+	float Step = 0.05f;
+	uint32_t Frames = 30; // Averaged before each change
+};
+
+// Picks the scale of the internal render resolution from recent frame
+// times. Pixel cost follows the area, so the side is scaled by the square
+// root of how far the frame time is from the target. The GPU time is used
+// when the backend has timer queries. Without them the frame period is
+// used, and a frame counts as CPU bound when recording, Flush left out,
+// takes most of it. Fewer pixels would not make such frames faster, so
+// they never lower the scale. Off until enabled.
+class DynamicResolution {
+public:
+	DynamicResolution(const DynamicResolutionSpecification& specs = { });
+	~DynamicResolution() = default;
+
+	// Once per frame, with the info of the frame that just ended
+	void Update(const FrameDebugInfo& info);
+
+	// When disabled the scale stays at MaxScale
+	void SetEnabled(bool enabled);
+	bool IsEnabled() const { return m_Enabled; }
+
+	void SetSpecification(const DynamicResolutionSpecification& specs);
+	const DynamicResolutionSpecification& GetSpecification() const {
+		return m_Specs;
+	}
+
+	float GetScale() const { return m_Scale; }
+	uint32_t Scale(uint32_t size) const;
+
+private:
+	DynamicResolutionSpecification m_Specs;
+	bool m_Enabled = false;
+	float m_Scale;
+
+	float m_Total = 0.0f;
+	float m_CPUTotal = 0.0f;
+	uint32_t m_Count = 0;
+
+	// Steps up tried on target, see Update
+	bool m_Probed = false;
+	uint32_t m_ProbeDelay = 1;
+	uint32_t m_ProbeWait = 0;
+
+private:
+	void Probe();
+};
+
+}
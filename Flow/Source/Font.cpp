@@ -0,0 +1,261 @@
+#include "Font.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <VolcaniCore/Core/Log.h>
+
+#include "TrueType.h"
+
+using namespace VolcaniCore;
+
+namespace Magma::Graphics {
+
+const uint32_t Font::MaxCachedStrings = 4096;
+const std::string Font::DefaultPath =
+	"Magma/assets/fonts/JetBrainsMono-Regular.ttf";
+
+// One pixel between glyphs so filtering never reaches a neighbour
+static const uint32_t s_Padding = 1;
+
+Font::Font(const GlyphRasterizer& rasterizer, uint32_t pixelSize,
+		   uint32_t spread, uint32_t atlasSize)
+	: m_Rasterizer(rasterizer), m_PixelSize(pixelSize), m_Spread(spread),
+		m_AtlasSize(atlasSize), m_Atlas(atlasSize * atlasSize, 0)
+{
+
+}
+
+Ref<Font> Font::Create(const std::string& path, uint32_t pixelSize,
+					   uint32_t spread, uint32_t atlasSize)
+{
+	GlyphRasterizer rasterizer;
+	if(auto file = TrueType::Load(path))
+		rasterizer =
+			[file](uint32_t codepoint, uint32_t size, GlyphBitmap& out)
+			{
+				return file->Rasterize(codepoint, size, out);
+			};
+	else
+		VOLCANICORE_LOG_WARNING("Could not load font '%s'", path.c_str());
+
+	return CreateRef<Font>(rasterizer, pixelSize, spread, atlasSize);
+}
+
+void Font::SetLineHeight(float ems) {
+	m_LineHeight = ems;
+	m_Layouts.clear();
+	m_LayoutIndex.clear();
+}
+
+void Font::Clear() {
+	std::fill(m_Atlas.begin(), m_Atlas.end(), 0);
+	m_ShelfX = 0;
+	m_ShelfY = 0;
+	m_ShelfHeight = 0;
+	m_Dirty = true;
+	m_WarnedFull = false;
+
+	m_Glyphs.clear();
+	m_Missing.clear();
+	m_Layouts.clear();
+	m_LayoutIndex.clear();
+}
+
+bool Font::Pack(uint32_t width, uint32_t height, uint32_t& x, uint32_t& y)
+{
+	width += s_Padding;
+	height += s_Padding;
+	if(width > m_AtlasSize || height > m_AtlasSize)
+		return false;
+
+	if(m_ShelfX + width > m_AtlasSize) {
+		m_ShelfY += m_ShelfHeight;
+		m_ShelfX = 0;
+		m_ShelfHeight = 0;
+	}
+	if(m_ShelfY + height > m_AtlasSize)
+		return false;
+
+	x = m_ShelfX;
+	y = m_ShelfY;
+	m_ShelfX += width;
+	m_ShelfHeight = std::max(m_ShelfHeight, height);
+	return true;
+}
+
+const Glyph* Font::GetGlyph(uint32_t codepoint) {
+	auto found = m_Glyphs.find(codepoint);
+	if(found != m_Glyphs.end())
+		return &found->second;
+	if(m_Missing.count(codepoint))
+		return nullptr;
+
+	GlyphBitmap bitmap;
+	if(!m_Rasterizer || !m_Rasterizer(codepoint, m_PixelSize, bitmap)) {
+		m_Missing[codepoint] = true;
+		return nullptr;
+	}
+
+	float em = (float)m_PixelSize;
+	Glyph glyph;
+	glyph.Advance = bitmap.Advance / em;
+	glyph.Offset = glm::vec2(0.0f);
+	glyph.Size = glm::vec2(0.0f);
+	glyph.UV = glm::vec4(0.0f);
+
+	// Whitespace only moves the pen
+	if(!bitmap.Width || !bitmap.Height)
+		return &(m_Glyphs[codepoint] = glyph);
+
+	uint32_t width = bitmap.Width + 2 * m_Spread;
+	uint32_t height = bitmap.Height + 2 * m_Spread;
+	uint32_t x, y;
+	if(!Pack(width, height, x, y)) {
+		if(!m_WarnedFull)
+			VOLCANICORE_LOG_WARNING("Font atlas is full");
+		m_WarnedFull = true;
+		return nullptr;
+	}
+
+	uint8_t* out = &m_Atlas[y * m_AtlasSize + x];
+	GenerateSDF(bitmap, m_Spread, out, m_AtlasSize);
+	m_Dirty = true;
+
+	// The atlas is stored top row first, like the bitmaps
+	float size = (float)m_AtlasSize;
+	glyph.Offset =
+		glm::vec2(bitmap.BearingX - (int32_t)m_Spread,
+				  bitmap.BearingY - (int32_t)bitmap.Height - (int32_t)m_Spread)
+		/ em;
+	glyph.Size = glm::vec2(width, height) / em;
+	glyph.UV =
+		glm::vec4(x / size, (y + height) / size, (x + width) / size, y / size);
+
+	return &(m_Glyphs[codepoint] = glyph);
+}
+
+static uint32_t NextCodepoint(const std::string& text, uint64_t& i) {
+	uint8_t c = text[i++];
+	uint32_t extra = 0;
+	uint32_t codepoint = c;
+	if(c >= 0xF0) {
+		extra = 3;
+		codepoint = c & 0x07;
+	}
+	else if(c >= 0xE0) {
+		extra = 2;
+		codepoint = c & 0x0F;
+	}
+	else if(c >= 0xC0) {
+		extra = 1;
+		codepoint = c & 0x1F;
+	}
+
+	for(; extra && i < text.size(); extra--)
+		codepoint = (codepoint << 6) | (text[i++] & 0x3F);
+	return codepoint;
+}
+
+const TextLayout& Font::Shape(const std::string& text) {
+	auto found = m_LayoutIndex.find(text);
+	if(found != m_LayoutIndex.end()) {
+		m_Layouts.splice(m_Layouts.begin(), m_Layouts, found->second);
+		return found->second->second;
+	}
+
+	if(m_Layouts.size() >= MaxCachedStrings) {
+		m_LayoutIndex.erase(m_Layouts.back().first);
+		m_Layouts.pop_back();
+	}
+
+	m_Layouts.emplace_front(text, TextLayout{ });
+	m_LayoutIndex[text] = m_Layouts.begin();
+	auto& layout = m_Layouts.front().second;
+	glm::vec2 pen = glm::vec2(0.0f);
+	float width = 0.0f;
+	uint32_t lines = 1;
+
+	for(uint64_t i = 0; i < text.size(); ) {
+		uint32_t codepoint = NextCodepoint(text, i);
+		if(codepoint == '\n') {
+			width = std::max(width, pen.x);
+			pen = glm::vec2(0.0f, pen.y - m_LineHeight);
+			lines++;
+			continue;
+		}
+
+		auto* glyph = GetGlyph(codepoint);
+		if(!glyph)
+			continue;
+
+		if(glyph->Size.x > 0.0f)
+			layout.Glyphs
+			.Add({ glm::vec4(pen + glyph->Offset, glyph->Size), glyph->UV });
+		pen.x += glyph->Advance;
+	}
+
+	width = std::max(width, pen.x);
+	layout.Size = glm::vec2(width, lines * m_LineHeight);
+	return layout;
+}
+
+Ref<Texture> Font::GetTexture() {
+	if(!m_Texture)
+		m_Texture = Texture::Create(m_AtlasSize, m_AtlasSize);
+	if(!m_Dirty)
+		return m_Texture;
+
+	// The distance goes in every channel
+	std::vector<uint32_t> pixels(m_Atlas.size());
+	for(uint64_t i = 0; i < m_Atlas.size(); i++)
+		pixels[i] = m_Atlas[i] * 0x01010101u;
+
+	m_Texture->SetData(pixels.data());
+	m_Dirty = false;
+	return m_Texture;
+}
+
+void Font::GenerateSDF(const GlyphBitmap& bitmap, uint32_t spread,
+					   uint8_t* out, uint32_t stride)
+{
+	int32_t width = bitmap.Width;
+	int32_t height = bitmap.Height;
+	int32_t range = spread;
+
+	auto inside =
+		[&](int32_t x, int32_t y) -> bool
+		{
+			if(x < 0 || y < 0 || x >= width || y >= height)
+				return false;
+			return bitmap.Coverage[y * width + x] >= 128;
+		};
+
+	// Brute force over the texels within the spread. Glyphs are small and
+	// only ever generated once
+	for(int32_t y = -range; y < height + range; y++)
+		for(int32_t x = -range; x < width + range; x++) {
+			bool in = inside(x, y);
+			float nearest = range + 0.5f;
+
+			for(int32_t dy = -range; dy <= range; dy++)
+				for(int32_t dx = -range; dx <= range; dx++) {
+					if(inside(x + dx, y + dy) == in)
+						continue;
+
+					float distance = std::sqrt(float(dx * dx + dy * dy));
+					nearest = std::min(nearest, distance);
+				}
+
+			// The outline runs halfway between two texels
+			float distance = (nearest - 0.5f) / range;
+			float value = 0.5f + 0.5f * (in ? distance : -distance);
+			value = std::clamp(value, 0.0f, 1.0f);
+
+			uint32_t row = y + range;
+			uint32_t column = x + range;
+			out[row * stride + column] = uint8_t(value * 255.0f + 0.5f);
+		}
+}
+
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <list>
+#include <string>
+#include <vector>
+
+#include <VolcaniCore/Core/Defines.h>
+#include <VolcaniCore/Core/Math.h>
+
+#include "Graphics/Texture.h"
+
+using namespace VolcaniCore;
+
+namespace Magma::Graphics {
+
+// Coverage of one glyph, one byte per pixel, rows from the top down
+struct GlyphBitmap {
+	uint32_t Width = 0;
+	uint32_t Height = 0;
+	int32_t BearingX = 0; // Pixels from the pen to the left edge
+	int32_t BearingY = 0; // Pixels from the baseline up to the top edge
+	float Advance = 0.0f; // Pixels
+	std::vector<uint8_t> Coverage;
+};
+
+// Renders a codepoint at a height in pixels. False when the font has no
+// glyph for it
+using GlyphRasterizer = Func<bool, uint32_t, uint32_t, GlyphBitmap&>;
+
+// Sizes are in ems, one em being the height glyphs are rasterized at
+struct Glyph {
+	glm::vec2 Offset; // From the pen to the bottom left corner
+	glm::vec2 Size;
+	glm::vec4 UV; // Bottom left, then top right
+	float Advance;
+};
+
+struct GlyphQuad {
+	glm::vec4 Rect; // Bottom left corner, then size
+	glm::vec4 UV;
+};
+
+// A string placed with its first baseline at the origin, lines going down
+struct TextLayout {
+	List<GlyphQuad> Glyphs;
+	glm::vec2 Size = glm::vec2(0.0f);
+};
+
+// Signed distance field glyphs, packed into one atlas the first time they
+// are used. Glyphs, the atlas and the layout of strings are all built on
+// the CPU, only GetTexture touches the backend.
+class Font {
+public:
+	// Rasterized from a TrueType file. A font that fails to load has no
+	// glyphs
+	static Ref<Font> Create(const std::string& path = DefaultPath,
+							uint32_t pixelSize = 48, uint32_t spread = 6,
+							uint32_t atlasSize = 1024);
+
+	Font(const GlyphRasterizer& rasterizer, uint32_t pixelSize = 48,
+		 uint32_t spread = 6, uint32_t atlasSize = 1024);
+	~Font() = default;
+
+	Font(const Font&) = delete;
+	Font& operator =(const Font&) = delete;
+
+	// Nullptr when the font has no glyph for the codepoint or the atlas
+	// is full
+	const Glyph* GetGlyph(uint32_t codepoint);
+
+	// UTF-8, lines break at '\n'. Laid out once, then cached
+	const TextLayout& Shape(const std::string& text);
+
+	// Uploads the atlas when glyphs were added since the last call.
+	// Render thread only
+	Ref<Texture> GetTexture();
+
+	// One byte per texel, 128 on the outline and higher inside
+	const std::vector<uint8_t>& GetAtlas() const { return m_Atlas; }
+	uint32_t GetAtlasSize() const { return m_AtlasSize; }
+	uint32_t GetGlyphCount() const { return m_Glyphs.size(); }
+	uint32_t GetCachedCount() const { return m_Layouts.size(); }
+
+	void SetLineHeight(float ems);
+	float GetLineHeight() const { return m_LineHeight; }
+
+	// Forgets every glyph and string, the atlas starts over empty
+	void Clear();
+
+	// Distance to the outline of the coverage, spread pixels either way
+	// mapped to 0-255. out is the bitmap grown by spread on every side
+	static void GenerateSDF(const GlyphBitmap& bitmap, uint32_t spread,
+							uint8_t* out, uint32_t stride);
+
+	// Strings cached at once, the least recently shaped is dropped first
+	static const uint32_t MaxCachedStrings;
+
+	static const std::string DefaultPath;
+
+private:
+	GlyphRasterizer m_Rasterizer;
+	uint32_t m_PixelSize;
+	uint32_t m_Spread;
+	float m_LineHeight = 1.25f;
+
+	// Glyphs are packed in shelves, rows as tall as their tallest glyph
+	uint32_t m_AtlasSize;
+	std::vector<uint8_t> m_Atlas;
+	uint32_t m_ShelfX = 0;
+	uint32_t m_ShelfY = 0;
+	uint32_t m_ShelfHeight = 0;
+	bool m_Dirty = false;
+	bool m_WarnedFull = false;
+	Ref<Texture> m_Texture;
+
+	Map<uint32_t, Glyph> m_Glyphs;
+	Map<uint32_t, bool> m_Missing;
+	// Most recently shaped first
+	std::list<std::pair<std::string, TextLayout>> m_Layouts;
+	Map<std::string, decltype(m_Layouts)::iterator> m_LayoutIndex;
+
+private:
+	bool Pack(uint32_t width, uint32_t height, uint32_t& x, uint32_t& y);
+};
+
+}
@@ -0,0 +1,80 @@
+#include "FrameArena.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include <VolcaniCore/Core/Assert.h>
+
+using namespace VolcaniCore;
+
+namespace Magma::Graphics {
+
+FrameArena::FrameArena(uint64_t blockSize)
+	: m_BlockSize(blockSize)
+{
+	AddBlock(m_BlockSize);
+}
+
+FrameArena::~FrameArena() {
+	Reset();
+	for(auto& block : m_Blocks)
+		std::free(block.Data);
+}
+
+void* FrameArena::Allocate(uint64_t size, uint64_t alignment) {
+	VOLCANICORE_ASSERT((alignment & (alignment - 1)) == 0,
+					   "Alignment must be a power of two");
+
+	while(true) {
+		Block& block = m_Blocks[m_Current];
+		uint64_t start = (block.Offset + alignment - 1) & ~(alignment - 1);
+
+		if(start + size <= block.Size) {
+			m_Used += start + size - block.Offset;
+			block.Offset = start + size;
+			m_HighWaterMark = std::max(m_HighWaterMark, m_Used);
+			return block.Data + start;
+		}
+
+		AddBlock(size + alignment);
+	}
+}
+
+void FrameArena::Reset() {
+	for(auto it = m_Destructors.rbegin(); it != m_Destructors.rend(); it++)
+		it->Destroy(it->Object);
+	m_Destructors.clear();
+
+	// A frame that spilled over into several blocks gets a single block
+	// big enough for all of it, so the next frame stays contiguous
+	if(m_Blocks.size() > 1) {
+		uint64_t total = GetCapacity();
+		for(auto& block : m_Blocks)
+			std::free(block.Data);
+		m_Blocks.clear();
+		AddBlock(total);
+	}
+
+	for(auto& block : m_Blocks)
+		block.Offset = 0;
+	m_Current = 0;
+	m_Used = 0;
+}
+
+uint64_t FrameArena::GetCapacity() const {
+	uint64_t capacity = 0;
+	for(auto& block : m_Blocks)
+		capacity += block.Size;
+	return capacity;
+}
+
+void FrameArena::AddBlock(uint64_t minSize) {
+	uint64_t size = std::max(m_BlockSize, minSize);
+	auto* data = static_cast<uint8_t*>(std::malloc(size));
+	VOLCANICORE_ASSERT(data, "Could not allocate frame arena block");
+
+	m_Blocks.push_back({ data, size, 0 });
+	m_Current = (uint32_t)m_Blocks.size() - 1;
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Magma::Graphics {
+
+// Linear allocator for memory that lives for exactly one frame.
+// Nothing is freed individually, Reset() releases everything at once.
+class FrameArena {
+public:
+	FrameArena(uint64_t blockSize = 256 * 1024);
+	~FrameArena();
+
+	FrameArena(const FrameArena&) = delete;
+	FrameArena& operator =(const FrameArena&) = delete;
+
+	void* Allocate(uint64_t size,
+				   uint64_t alignment = alignof(std::max_align_t));
+
+	template<typename T, typename ...Args>
+	T* New(Args&&... args) {
+		void* ptr = Allocate(sizeof(T), alignof(T));
+		T* obj = new (ptr) T(std::forward<Args>(args)...);
+
+		if constexpr(!std::is_trivially_destructible_v<T>)
+			m_Destructors.push_back(
+				{ obj, [](void* p) { static_cast<T*>(p)->~T(); } });
+
+		return obj;
+	}
+
+	template<typename T>
+	T* NewArray(uint64_t count) {
+		static_assert(std::is_trivially_destructible_v<T>,
+					  "Arena arrays must be trivially destructible");
+		return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+	}
+
+	void Reset();
+
+	uint64_t GetUsed() const { return m_Used; }
+	uint64_t GetCapacity() const;
+	uint64_t GetHighWaterMark() const { return m_HighWaterMark; }
+
+private:
+	struct Block {
+		uint8_t* Data;
+		uint64_t Size;
+		uint64_t Offset;
+	};
+
+	struct Destructor {
+		void* Object;
+		void (*Destroy)(void*);
+	};
+
+	const uint64_t m_BlockSize;
+	std::vector<Block> m_Blocks;
+	std::vector<Destructor> m_Destructors;
+	uint32_t m_Current = 0;
+
+	uint64_t m_Used = 0;
+	uint64_t m_HighWaterMark = 0;
+
+private:
+	void AddBlock(uint64_t minSize);
+};
+
+}
\ No newline at end of file
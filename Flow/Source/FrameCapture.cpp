@@ -0,0 +1,402 @@
+#include "FrameCapture.h"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+#include <VolcaniCore/Core/Assert.h>
+
+#include "Renderer.h"
+#include "RenderPass.h"
+
+using namespace VolcaniCore;
+
+namespace Magma::Graphics {
+
+static const uint32_t s_Magic = 0x4346474D; // MGFC
+static const uint32_t s_Version = 1;
+
+class CaptureWriter {
+public:
+	CaptureWriter(const std::string& path)
+		: m_Stream(path, std::ios::binary) { }
+
+	template<typename T>
+	void Write(const T& value) {
+		static_assert(std::is_trivially_copyable_v<T>);
+		m_Stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	void Write(const std::string& str) {
+		Write((uint32_t)str.size());
+		m_Stream.write(str.data(), str.size());
+	}
+
+	void Write(const std::vector<uint8_t>& bytes) {
+		Write((uint64_t)bytes.size());
+		m_Stream.write(reinterpret_cast<const char*>(bytes.data()),
+					   bytes.size());
+	}
+
+	bool IsGood() const { return m_Stream.good(); }
+
+private:
+	std::ofstream m_Stream;
+};
+
+class CaptureReader {
+public:
+	CaptureReader(const std::string& path)
+		: m_Stream(path, std::ios::binary) { }
+
+	template<typename T>
+	T Read() {
+		static_assert(std::is_trivially_copyable_v<T>);
+		T value{ };
+		m_Stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+		return value;
+	}
+
+	std::string ReadString() {
+		std::string str(Read<uint32_t>(), '\0');
+		m_Stream.read(str.data(), str.size());
+		return str;
+	}
+
+	std::vector<uint8_t> ReadBytes() {
+		std::vector<uint8_t> bytes(Read<uint64_t>());
+		m_Stream.read(reinterpret_cast<char*>(bytes.data()), bytes.size());
+		return bytes;
+	}
+
+	bool IsGood() const { return m_Stream.good(); }
+
+private:
+	std::ifstream m_Stream;
+};
+
+static void WriteLayout(CaptureWriter& writer, const BufferLayout& layout) {
+	writer.Write((uint32_t)layout.Elements.Count());
+	for(auto& element : layout.Elements) {
+		writer.Write(element.Name);
+		writer.Write(element.Type);
+	}
+	writer.Write(layout.Dynamic);
+	writer.Write(layout.Instanced);
+}
+
+static BufferLayout ReadLayout(CaptureReader& reader) {
+	List<BufferElement> elements;
+	uint32_t count = reader.Read<uint32_t>();
+	for(uint32_t i = 0; i < count && reader.IsGood(); i++) {
+		auto name = reader.ReadString();
+		elements.Add({ name, reader.Read<BufferDataType>() });
+	}
+
+	bool dynamic = reader.Read<bool>();
+	bool instanced = reader.Read<bool>();
+	return BufferLayout{ elements, dynamic, instanced };
+}
+
+bool FrameCapture::Write(const RecordingRendererAPI& api,
+						 const std::string& path)
+{
+	CaptureWriter writer(path);
+	if(!writer.IsGood())
+		return false;
+
+	writer.Write(s_Magic);
+	writer.Write(s_Version);
+
+	uint32_t buffers = 0;
+	for(uint32_t id = 1; id <= api.GetBufferCount(); id++)
+		buffers += api.GetBuffer(id) != nullptr;
+
+	writer.Write(buffers);
+	for(uint32_t id = 1; id <= api.GetBufferCount(); id++) {
+		auto* buffer = api.GetBuffer(id);
+		if(!buffer)
+			continue;
+
+		auto& specs = buffer->Specs;
+		writer.Write(id);
+		WriteLayout(writer, specs.VertexLayout);
+		WriteLayout(writer, specs.InstanceLayout);
+		writer.Write((uint64_t)specs.MaxIndexCount);
+		writer.Write((uint64_t)specs.MaxVertexCount);
+		writer.Write((uint64_t)specs.MaxInstanceCount);
+
+		auto& data = api.GetBufferData(id);
+		writer.Write(data.Indices);
+		writer.Write(data.Vertices);
+		writer.Write(data.Instances);
+	}
+
+	writer.Write(api.GetPassCount());
+	for(uint32_t id = 1; id <= api.GetPassCount(); id++) {
+		auto* pass = api.GetPass(id);
+		writer.Write(id);
+		writer.Write(api.GetBufferID(pass->BufferData));
+		writer.Write(Renderer::GetPassName(pass));
+	}
+
+	auto& frame = api.GetLastFrame();
+	writer.Write((uint32_t)frame.Uploads.Count());
+	for(auto& upload : frame.Uploads) {
+		writer.Write(upload.Buffer);
+		writer.Write(upload.Index);
+		writer.Write(upload.Offset);
+		writer.Write(upload.Count);
+		writer.Write(upload.Bytes);
+		writer.Write(upload.Data);
+	}
+
+	writer.Write((uint32_t)frame.Commands.Count());
+	for(auto& command : frame.Commands) {
+		writer.Write(command.Pass);
+		writer.Write(command.Clear);
+		writer.Write(command.DepthTest);
+		writer.Write(command.Blending);
+		writer.Write(command.Culling);
+		writer.Write(command.ViewportWidth);
+		writer.Write(command.ViewportHeight);
+		writer.Write(command.IndicesIndex);
+		writer.Write(command.VerticesIndex);
+		writer.Write(command.ComputeX);
+
+		writer.Write((uint32_t)command.Uniforms.Count());
+		for(auto& uniform : command.Uniforms) {
+			writer.Write(uniform.Name);
+			writer.Write(uniform.Type);
+			writer.Write(uniform.Data);
+		}
+
+		writer.Write((uint32_t)command.Calls.Count());
+		for(auto& call : command.Calls)
+			writer.Write(call);
+	}
+
+	writer.Write(frame.Stats);
+	return writer.IsGood();
+}
+
+bool FrameReplay::Load(const std::string& path) {
+	CaptureReader reader(path);
+	if(!reader.IsGood())
+		return false;
+
+	if(reader.Read<uint32_t>() != s_Magic
+	|| reader.Read<uint32_t>() != s_Version)
+		return false;
+
+	m_Buffers.Clear();
+	m_Passes.Clear();
+	m_Frame = { };
+
+	uint32_t buffers = reader.Read<uint32_t>();
+	for(uint32_t i = 0; i < buffers && reader.IsGood(); i++) {
+		Buffer buffer;
+		buffer.ID = reader.Read<uint32_t>();
+		buffer.Specs.VertexLayout = ReadLayout(reader);
+		buffer.Specs.InstanceLayout = ReadLayout(reader);
+		buffer.Specs.MaxIndexCount = reader.Read<uint64_t>();
+		buffer.Specs.MaxVertexCount = reader.Read<uint64_t>();
+		buffer.Specs.MaxInstanceCount = reader.Read<uint64_t>();
+		buffer.Data.Indices = reader.ReadBytes();
+		buffer.Data.Vertices = reader.ReadBytes();
+		buffer.Data.Instances = reader.ReadBytes();
+		m_Buffers.Add(buffer);
+	}
+
+	uint32_t passes = reader.Read<uint32_t>();
+	for(uint32_t i = 0; i < passes && reader.IsGood(); i++) {
+		Pass pass;
+		pass.ID = reader.Read<uint32_t>();
+		pass.Buffer = reader.Read<uint32_t>();
+		pass.Name = reader.ReadString();
+		m_Passes.Add(pass);
+	}
+
+	uint32_t uploads = reader.Read<uint32_t>();
+	for(uint32_t i = 0; i < uploads && reader.IsGood(); i++) {
+		RecordedUpload upload;
+		upload.Buffer = reader.Read<uint32_t>();
+		upload.Index = reader.Read<DrawBufferIndex>();
+		upload.Offset = reader.Read<uint64_t>();
+		upload.Count = reader.Read<uint64_t>();
+		upload.Bytes = reader.Read<uint64_t>();
+		upload.Data = reader.ReadBytes();
+		m_Frame.Uploads.Add(upload);
+	}
+
+	uint32_t commands = reader.Read<uint32_t>();
+	for(uint32_t i = 0; i < commands && reader.IsGood(); i++) {
+		RecordedDrawCommand command;
+		command.Pass = reader.Read<uint32_t>();
+		command.Clear = reader.Read<bool>();
+		command.DepthTest = reader.Read<DepthTestingMode>();
+		command.Blending = reader.Read<BlendingMode>();
+		command.Culling = reader.Read<CullingMode>();
+		command.ViewportWidth = reader.Read<uint32_t>();
+		command.ViewportHeight = reader.Read<uint32_t>();
+		command.IndicesIndex = reader.Read<uint64_t>();
+		command.VerticesIndex = reader.Read<uint64_t>();
+		command.ComputeX = reader.Read<uint32_t>();
+
+		uint32_t uniforms = reader.Read<uint32_t>();
+		for(uint32_t j = 0; j < uniforms && reader.IsGood(); j++) {
+			RecordedUniform uniform;
+			uniform.Name = reader.ReadString();
+			uniform.Type = reader.Read<RecordedUniformType>();
+			uniform.Data = reader.ReadBytes();
+			uniform.Bytes = uniform.Data.size();
+			command.Uniforms.Add(uniform);
+		}
+
+		uint32_t calls = reader.Read<uint32_t>();
+		for(uint32_t j = 0; j < calls && reader.IsGood(); j++)
+			command.Calls.Add(reader.Read<DrawCall>());
+
+		m_Frame.Commands.Add(command);
+	}
+
+	m_Frame.Stats = reader.Read<RecordingStats>();
+	return reader.IsGood();
+}
+
+template<typename T>
+static T ReadUniform(const RecordedUniform& uniform) {
+	T value{ };
+	if(uniform.Data.size() == sizeof(T))
+		std::memcpy(&value, uniform.Data.data(), sizeof(T));
+	return value;
+}
+
+static void SetUniform(UniformData& data, const RecordedUniform& uniform) {
+	switch(uniform.Type) {
+		case RecordedUniformType::Int:
+			data.SetInput(uniform.Name, ReadUniform<int32_t>(uniform));
+			break;
+		case RecordedUniformType::Float:
+			data.SetInput(uniform.Name, ReadUniform<float>(uniform));
+			break;
+		case RecordedUniformType::Vec2:
+			data.SetInput(uniform.Name, ReadUniform<glm::vec2>(uniform));
+			break;
+		case RecordedUniformType::Vec3:
+			data.SetInput(uniform.Name, ReadUniform<glm::vec3>(uniform));
+			break;
+		case RecordedUniformType::Vec4:
+			data.SetInput(uniform.Name, ReadUniform<glm::vec4>(uniform));
+			break;
+		case RecordedUniformType::Mat4:
+			data.SetInput(uniform.Name, ReadUniform<glm::mat4>(uniform));
+			break;
+	}
+}
+
+static void SetContents(DrawBuffer* buffer, DrawBufferIndex type,
+						const std::vector<uint8_t>& bytes, uint64_t stride)
+{
+	if(bytes.empty() || !stride)
+		return;
+
+	Renderer::GetAPI()
+	->SetBufferData(buffer, type, bytes.data(), bytes.size() / stride);
+}
+
+ReplayResult FrameReplay::Run(uint32_t iterations,
+	const Func<Ref<ShaderPipeline>, const std::string&>& pipelines)
+{
+	using Clock = std::chrono::steady_clock;
+
+	auto* api = Renderer::GetAPI();
+	Map<uint32_t, DrawBuffer*> buffers;
+	Map<uint32_t, Ref<RenderPass>> passes;
+
+	// Setup is not timed. The final contents of each buffer go up first,
+	// the frame's own uploads are replayed on every iteration
+	for(auto& captured : m_Buffers) {
+		auto* buffer = api->NewDrawBuffer(captured.Specs);
+		SetContents(buffer, DrawBufferIndex::Indices,
+					captured.Data.Indices, sizeof(uint32_t));
+		SetContents(buffer, DrawBufferIndex::Vertices,
+					captured.Data.Vertices, captured.Specs.VertexLayout.Stride);
+		SetContents(buffer, DrawBufferIndex::Instances,
+					captured.Data.Instances,
+					captured.Specs.InstanceLayout.Stride);
+		buffers[captured.ID] = buffer;
+	}
+
+	for(auto& captured : m_Passes) {
+		Ref<ShaderPipeline> pipeline;
+		if(pipelines && !captured.Name.empty())
+			pipeline = pipelines(captured.Name);
+
+		DrawBuffer* buffer =
+			buffers.count(captured.Buffer) ? buffers[captured.Buffer] : nullptr;
+		auto pass = RenderPass::Create(captured.Name, pipeline);
+		pass->SetData(buffer);
+		passes[captured.ID] = pass;
+	}
+
+	ReplayResult result;
+	result.Iterations = iterations;
+	for(uint64_t i = 0; i < m_Frame.Commands.Count(); i++)
+		result.CommandTimes.Add(0.0f);
+
+	for(uint32_t i = 0; i < iterations; i++) {
+		auto frameStart = Clock::now();
+		api->StartFrame();
+
+		for(auto& upload : m_Frame.Uploads) {
+			if(upload.Data.empty() || !buffers.count(upload.Buffer))
+				continue;
+
+			api->SetBufferData(buffers[upload.Buffer], upload.Index,
+							   upload.Data.data(), upload.Count,
+							   upload.Offset);
+		}
+
+		for(uint64_t j = 0; j < m_Frame.Commands.Count(); j++) {
+			auto& captured = m_Frame.Commands[j];
+			auto commandStart = Clock::now();
+
+			DrawPass* pass =
+				passes.count(captured.Pass) ? passes[captured.Pass]->Get()
+											: nullptr;
+			auto* command = api->NewDrawCommand(pass);
+			command->Clear = captured.Clear;
+			command->DepthTest = captured.DepthTest;
+			command->Blending = captured.Blending;
+			command->Culling = captured.Culling;
+			command->ViewportWidth = captured.ViewportWidth;
+			command->ViewportHeight = captured.ViewportHeight;
+			command->IndicesIndex = captured.IndicesIndex;
+			command->VerticesIndex = captured.VerticesIndex;
+			command->ComputeX = captured.ComputeX;
+			command->Calls = captured.Calls;
+			for(auto& uniform : captured.Uniforms)
+				SetUniform(command->UniformData, uniform);
+
+			std::chrono::duration<float, std::milli> elapsed =
+				Clock::now() - commandStart;
+			result.CommandTimes[j] += elapsed.count() / iterations;
+		}
+
+		api->EndFrame();
+
+		std::chrono::duration<float, std::milli> elapsed =
+			Clock::now() - frameStart;
+		result.FrameTime += elapsed.count() / iterations;
+	}
+
+	passes.clear();
+	for(auto& [_, buffer] : buffers)
+		api->ReleaseBuffer(buffer);
+
+	return result;
+}
+
+}
\ No newline at end of file
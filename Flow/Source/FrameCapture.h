@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+
+#include <VolcaniCore/Core/Defines.h>
+
+#include "RecordingRendererAPI.h"
+
+using namespace VolcaniCore;
+
+namespace Magma::Graphics {
+
+// Writes the last frame a RecordingRendererAPI saw to a file, along with
+// the layout and contents of every buffer, so it can be replayed without
+// the scene, its assets or its scripts. The backend must keep data.
+class FrameCapture {
+public:
+	static bool Write(const RecordingRendererAPI& api,
+					  const std::string& path);
+};
+
+struct ReplayResult {
+	uint32_t Iterations = 0;
+	float FrameTime = 0.0f; // Average milliseconds per frame
+	List<float> CommandTimes; // Average milliseconds per command
+};
+
+// Submits a captured frame to whichever backend is current.
+// Textures, framebuffers and uniform buffers are GPU objects and are not
+// part of a capture, commands are replayed with their plain uniforms only.
+class FrameReplay {
+public:
+	FrameReplay() = default;
+	~FrameReplay() = default;
+
+	bool Load(const std::string& path);
+
+	// Each iteration replays the frame's uploads and commands and ends
+	// the backend's frame once. Command times cover handing a command to
+	// the backend, the frame time also covers drawing them. Pipelines are
+	// looked up by the name of the pass that recorded them, passes the
+	// lookup returns nothing for draw without one. Buffers and passes made
+	// for the run are released before it returns
+	ReplayResult Run(uint32_t iterations,
+		const Func<Ref<ShaderPipeline>, const std::string&>& pipelines = { });
+
+	const RecordedFrame& GetFrame() const { return m_Frame; }
+
+private:
+	struct Buffer {
+		uint32_t ID;
+		DrawBufferSpecification Specs;
+		RecordedBufferData Data;
+	};
+
+	struct Pass {
+		uint32_t ID;
+		uint32_t Buffer;
+		std::string Name;
+	};
+
+	List<Buffer> m_Buffers;
+	List<Pass> m_Passes;
+	RecordedFrame m_Frame;
+};
+
+}
\ No newline at end of file
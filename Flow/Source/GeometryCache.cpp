@@ -0,0 +1,122 @@
+#include "GeometryCache.h"
+
+#include "RendererAPI.h"
+#include "Renderer.h"
+
+using namespace VolcaniCore;
+
+namespace Magma::Graphics {
+
+void GeometryCache::Init(DrawBuffer* buffer, uint64_t maxIndices,
+						 uint64_t maxVertices, VertexFormat format)
+{
+	m_Buffer = buffer;
+	m_Format = format;
+	m_Indices.Init(maxIndices);
+	m_Vertices.Init(maxVertices);
+	m_Entries.clear();
+	m_MissingIndices = 0;
+	m_MissingVertices = 0;
+}
+
+const GeometryRange* GeometryCache::Get(Ref<Mesh> root, SubMesh& mesh) {
+	// The address may belong to a submesh of a mesh released earlier
+	auto it = m_Entries.find(&mesh);
+	if(it != m_Entries.end()) {
+		if(it->second.Owner.lock() == root)
+			return &it->second.Range;
+
+		Free(it->second);
+		m_Entries.erase(it);
+	}
+
+	uint64_t indexCount = mesh.Indices.Count();
+	uint64_t vertexCount = mesh.Vertices.Count();
+
+	GeometryRange range;
+	range.IndexCount = indexCount;
+	range.VertexCount = vertexCount;
+	bool hasIndices = m_Indices.Allocate(indexCount, range.IndexStart);
+	bool hasVertices = m_Vertices.Allocate(vertexCount, range.VertexStart);
+	if(!hasIndices || !hasVertices) {
+		if(hasIndices)
+			m_Indices.Free(range.IndexStart, indexCount);
+		if(hasVertices)
+			m_Vertices.Free(range.VertexStart, vertexCount);
+
+		m_MissingIndices += indexCount;
+		m_MissingVertices += vertexCount;
+		return nullptr;
+	}
+
+	Renderer::GetAPI()
+	->SetBufferData(m_Buffer, DrawBufferIndex::Indices,
+					mesh.Indices.GetBuffer().Get(), indexCount,
+					range.IndexStart);
+	const void* vertices = mesh.Vertices.GetBuffer().Get();
+	if(m_Format != VertexFormat::Float) {
+		m_Staging.resize(vertexCount * Vertices::GetStride(m_Format));
+		range.Dequantize =
+			Vertices::Encode(m_Format, mesh.Vertices.GetBuffer().Get(),
+							 vertexCount, m_Staging.data());
+		vertices = m_Staging.data();
+	}
+
+	Renderer::GetAPI()
+	->SetBufferData(m_Buffer, DrawBufferIndex::Vertices, vertices,
+					vertexCount, range.VertexStart);
+	m_Uploaded += indexCount * sizeof(uint32_t)
+				+ vertexCount * m_Buffer->Specs.VertexLayout.Stride;
+
+	auto& entry = m_Entries[&mesh];
+	entry.Owner = root;
+	entry.Range = range;
+	return &entry.Range;
+}
+
+void GeometryCache::Collect() {
+	for(auto it = m_Entries.begin(); it != m_Entries.end(); ) {
+		if(!it->second.Owner.expired()) {
+			it++;
+			continue;
+		}
+
+		Free(it->second);
+		it = m_Entries.erase(it);
+	}
+
+	m_MissingIndices = 0;
+	m_MissingVertices = 0;
+	m_Uploaded = 0;
+}
+
+void GeometryCache::Release(SubMesh& mesh) {
+	auto it = m_Entries.find(&mesh);
+	if(it == m_Entries.end())
+		return;
+
+	Free(it->second);
+	m_Entries.erase(it);
+}
+
+// A miss means the space, or a free range large enough, ran out.
+// Asking for more than the capacity makes sure the buffer grows
+uint64_t GeometryCache::GetIndexDemand() const {
+	if(!m_MissingIndices)
+		return m_Indices.GetUsed();
+	return m_Indices.GetCapacity() + m_MissingIndices;
+}
+
+uint64_t GeometryCache::GetVertexDemand() const {
+	if(!m_MissingVertices)
+		return m_Vertices.GetUsed();
+	return m_Vertices.GetCapacity() + m_MissingVertices;
+}
+
+void GeometryCache::Free(Entry& entry) {
+	auto& range = entry.Range;
+	m_Indices.Free(range.IndexStart, range.IndexCount);
+	m_Vertices.Free(range.VertexStart, range.VertexCount);
+}
+
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <VolcaniCore/Core/Defines.h>
+#include <VolcaniCore/Core/Math.h>
+
+#include "Graphics/RendererAPI.h"
+#include "Graphics/Mesh.h"
+
+#include "RangeAllocator.h"
+#include "VertexFormat.h"
+
+using namespace VolcaniCore;
+
+namespace Magma::Graphics {
+
+struct GeometryRange {
+	uint64_t IndexStart  = 0;
+	uint64_t IndexCount  = 0;
+	uint64_t VertexStart = 0;
+	uint64_t VertexCount = 0;
+
+	// Takes decoded positions back to mesh units, see Vertices::Encode
+	glm::vec4 Dequantize = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+};
+
+// Keeps submesh geometry resident in the index and vertex streams of a
+// DrawBuffer. A submesh is uploaded the first time it is drawn and keeps
+// its range until the mesh owning it is released, so frames that only
+// move things upload nothing but instances.
+class GeometryCache {
+public:
+	GeometryCache() = default;
+	~GeometryCache() = default;
+
+	GeometryCache(const GeometryCache&) = delete;
+	GeometryCache& operator =(const GeometryCache&) = delete;
+
+	// Forgets everything, the buffer is assumed to hold nothing. Vertices
+	// are written in format, which has to match the buffer's layout
+	void Init(DrawBuffer* buffer, uint64_t maxIndices, uint64_t maxVertices,
+			  VertexFormat format = VertexFormat::Float);
+
+	// Render thread only. Nullptr when there is no room this frame
+	const GeometryRange* Get(Ref<Mesh> root, SubMesh& mesh);
+
+	// Frees the ranges of meshes that have been released
+	void Collect();
+	// Frees the range of a submesh destroyed while its mesh lives on
+	void Release(SubMesh& mesh);
+
+	// What the buffer would need to hold everything asked for this frame
+	uint64_t GetIndexDemand() const;
+	uint64_t GetVertexDemand() const;
+	uint64_t GetResidentCount() const { return m_Entries.size(); }
+	// Bytes uploaded since the last Collect
+	uint64_t GetUploaded() const { return m_Uploaded; }
+
+private:
+	struct Entry {
+		std::weak_ptr<Mesh> Owner;
+		GeometryRange Range;
+	};
+
+	DrawBuffer* m_Buffer = nullptr;
+	VertexFormat m_Format = VertexFormat::Float;
+	std::vector<uint8_t> m_Staging;
+	RangeAllocator m_Indices;
+	RangeAllocator m_Vertices;
+	Map<SubMesh*, Entry> m_Entries;
+
+	uint64_t m_MissingIndices = 0;
+	uint64_t m_MissingVertices = 0;
+	uint64_t m_Uploaded = 0;
+
+private:
+	void Free(Entry& entry);
+};
+
+}
@@ -0,0 +1,170 @@
+#include "GrowableBuffer.h"
+
+#include <algorithm>
+
+#include <VolcaniCore/Core/Log.h>
+
+#include "Renderer.h"
+#include "RendererAPI.h"
+
+using namespace VolcaniCore;
+
+namespace Magma::Graphics {
+
+static uint64_t s_Budget = 512ull * 1024 * 1024;
+static uint64_t s_Allocated = 0;
+static List<GrowableBuffer*> s_Buffers;
+
+GrowableBuffer::GrowableBuffer(const std::string& name,
+							   const DrawBufferSpecification& specs)
+	: m_Name(name), m_Specs(specs),
+		m_NewVertexLayout(specs.VertexLayout),
+		m_NewInstanceLayout(specs.InstanceLayout)
+{
+	m_Buffer = Renderer::GetAPI()->NewDrawBuffer(m_Specs);
+	m_Streams[0].Capacity = m_Specs.MaxIndexCount;
+	m_Streams[1].Capacity = m_Specs.MaxVertexCount;
+	m_Streams[2].Capacity = m_Specs.MaxInstanceCount;
+
+	s_Allocated += GetBytes(m_Specs);
+	s_Buffers.Add(this);
+}
+
+GrowableBuffer::~GrowableBuffer() {
+	Renderer::GetAPI()->ReleaseBuffer(m_Buffer);
+	s_Allocated -= GetBytes(m_Specs);
+
+	auto [found, i] =
+		s_Buffers.Find([this](GrowableBuffer* b) -> bool { return b == this; });
+	if(found)
+		s_Buffers.Pop(i);
+}
+
+uint64_t GrowableBuffer::GetCapacity(DrawBufferIndex index) const {
+	return GetStream(index).Capacity;
+}
+
+bool GrowableBuffer::Request(DrawBufferIndex index, uint64_t count) {
+	auto& stream = GetStream(index);
+	stream.Used += count;
+	return stream.Used <= stream.Capacity;
+}
+
+void GrowableBuffer::SetDemand(DrawBufferIndex index, uint64_t count) {
+	GetStream(index).Used = count;
+}
+
+void GrowableBuffer::SetVertexLayout(const BufferLayout& layout) {
+	m_NewVertexLayout = layout;
+	m_Rebuild = true;
+}
+
+void GrowableBuffer::SetInstanceLayout(const BufferLayout& layout) {
+	m_NewInstanceLayout = layout;
+	m_Rebuild = true;
+}
+
+bool GrowableBuffer::Resize() {
+	auto specs = m_Specs;
+	bool grow = m_Rebuild;
+	if(m_Rebuild) {
+		specs.VertexLayout = m_NewVertexLayout;
+		specs.InstanceLayout = m_NewInstanceLayout;
+	}
+	m_Rebuild = false;
+
+	uint64_t* capacities[] =
+	{
+		&specs.MaxIndexCount, &specs.MaxVertexCount, &specs.MaxInstanceCount
+	};
+
+	uint64_t current = GetBytes(m_Specs);
+	for(uint32_t i = 0; i < 3; i++) {
+		auto& stream = m_Streams[i];
+		stream.Peak = std::max(stream.Peak, stream.Used);
+
+		// Doubles one stream at a time so a stream that can't fit in the
+		// budget still leaves room for the others
+		uint64_t& capacity = *capacities[i];
+		while(capacity && capacity < stream.Used) {
+			capacity *= 2;
+			uint64_t bytes = GetBytes(specs);
+			if(s_Allocated - current + bytes > s_Budget) {
+				capacity /= 2;
+				if(!m_WarnedBudget)
+					VOLCANICORE_LOG_WARNING(
+						"Buffer '%s' is over the memory budget",
+						m_Name.c_str());
+				m_WarnedBudget = true;
+				break;
+			}
+
+			grow = true;
+		}
+
+		stream.Used = 0;
+	}
+
+	if(!grow)
+		return false;
+
+	auto* old = m_Buffer;
+	m_Buffer = Renderer::GetAPI()->NewDrawBuffer(specs);
+	Renderer::RebindBuffer(old, m_Buffer);
+	Renderer::GetAPI()->ReleaseBuffer(old);
+
+	s_Allocated += GetBytes(specs) - current;
+	m_Specs = specs;
+	m_Streams[0].Capacity = specs.MaxIndexCount;
+	m_Streams[1].Capacity = specs.MaxVertexCount;
+	m_Streams[2].Capacity = specs.MaxInstanceCount;
+	return true;
+}
+
+BufferDebugInfo GrowableBuffer::GetDebugInfo() const {
+	BufferDebugInfo info;
+	info.Name = m_Name;
+	info.Bytes = GetBytes(m_Specs);
+	info.Indices = m_Streams[0];
+	info.Vertices = m_Streams[1];
+	info.Instances = m_Streams[2];
+	return info;
+}
+
+void GrowableBuffer::SetBudget(uint64_t bytes) {
+	s_Budget = bytes;
+}
+
+uint64_t GrowableBuffer::GetBudget() {
+	return s_Budget;
+}
+
+uint64_t GrowableBuffer::GetAllocated() {
+	return s_Allocated;
+}
+
+const List<GrowableBuffer*>& GrowableBuffer::GetBuffers() {
+	return s_Buffers;
+}
+
+BufferStreamInfo& GrowableBuffer::GetStream(DrawBufferIndex index) {
+	if(index == DrawBufferIndex::Indices)
+		return m_Streams[0];
+	if(index == DrawBufferIndex::Vertices)
+		return m_Streams[1];
+	return m_Streams[2];
+}
+
+const BufferStreamInfo&
+GrowableBuffer::GetStream(DrawBufferIndex index) const {
+	return const_cast<GrowableBuffer*>(this)->GetStream(index);
+}
+
+uint64_t
+GrowableBuffer::GetBytes(const DrawBufferSpecification& specs) const {
+	return specs.MaxIndexCount * sizeof(uint32_t)
+		 + specs.MaxVertexCount * specs.VertexLayout.Stride
+		 + specs.MaxInstanceCount * specs.InstanceLayout.Stride;
+}
+
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <string>
+
+#include <VolcaniCore/Core/Defines.h>
+
+#include "Graphics/RendererAPI.h"
+
+using namespace VolcaniCore;
+
+namespace Magma::Graphics {
+
+struct BufferStreamInfo {
+	uint64_t Capacity = 0;
+	uint64_t Used = 0; // Demand of the last frame, may exceed the capacity
+	uint64_t Peak = 0;
+};
+
+struct BufferDebugInfo {
+	std::string Name;
+	uint64_t Bytes = 0;
+
+	BufferStreamInfo Indices;
+	BufferStreamInfo Vertices;
+	BufferStreamInfo Instances;
+};
+
+// A DrawBuffer for data that is uploaded again every frame. It starts
+// small, and between frames it is recreated with double the capacity of
+// whichever stream ran out, as long as all growable buffers together stay
+// within the budget. Passes drawing from the old buffer are moved over by
+// Renderer::RebindBuffer.
+class GrowableBuffer {
+public:
+	GrowableBuffer(const std::string& name,
+				   const DrawBufferSpecification& specs);
+	~GrowableBuffer();
+
+	GrowableBuffer(const GrowableBuffer&) = delete;
+	GrowableBuffer& operator =(const GrowableBuffer&) = delete;
+
+	DrawBuffer* Get() const { return m_Buffer; }
+	uint64_t GetCapacity(DrawBufferIndex index) const;
+
+	// Adds to this frame's demand. False when the data does not fit,
+	// the caller drops it and the buffer grows before the next frame
+	bool Request(DrawBufferIndex index, uint64_t count);
+
+	// Demand measured somewhere else, such as a RingBuffer
+	void SetDemand(DrawBufferIndex index, uint64_t count);
+
+	// Take effect on the next Resize, which recreates the buffer
+	void SetVertexLayout(const BufferLayout& layout);
+	void SetInstanceLayout(const BufferLayout& layout);
+
+	// Call between frames. True when the buffer was recreated
+	bool Resize();
+
+	BufferDebugInfo GetDebugInfo() const;
+
+	static void SetBudget(uint64_t bytes);
+	static uint64_t GetBudget();
+	static uint64_t GetAllocated();
+	static const List<GrowableBuffer*>& GetBuffers();
+
+private:
+	std::string m_Name;
+	DrawBufferSpecification m_Specs;
+	DrawBuffer* m_Buffer;
+
+	BufferStreamInfo m_Streams[3];
+	bool m_WarnedBudget = false;
+
+	BufferLayout m_NewVertexLayout;
+	BufferLayout m_NewInstanceLayout;
+	bool m_Rebuild = false;
+
+private:
+	BufferStreamInfo& GetStream(DrawBufferIndex index);
+	const BufferStreamInfo& GetStream(DrawBufferIndex index) const;
+	uint64_t GetBytes(const DrawBufferSpecification& specs) const;
+};
+
+}
@@ -0,0 +1,90 @@
+#include "InstanceFormat.h"
+
+#include <cstring>
+
+#include <glm/gtc/quaternion.hpp>
+
+using namespace VolcaniCore;
+
+namespace Magma::Graphics::Instances {
+
+BufferLayout GetLayout(InstanceFormat format) {
+	List<BufferElement> elements;
+	if(format == InstanceFormat::Matrix)
+		elements = { { "Transform", BufferDataType::Mat4 } };
+	else if(format == InstanceFormat::Affine)
+		elements =
+		{
+			{ "Row0", BufferDataType::Vec4 },
+			{ "Row1", BufferDataType::Vec4 },
+			{ "Row2", BufferDataType::Vec4 }
+		};
+	else
+		elements =
+		{
+			{ "PositionScale", BufferDataType::Vec4 },
+			{ "Rotation",	   BufferDataType::Vec4 }
+		};
+
+	return BufferLayout{ elements, true, true };
+}
+
+uint64_t GetStride(InstanceFormat format) {
+	if(format == InstanceFormat::Matrix)
+		return sizeof(glm::mat4);
+	if(format == InstanceFormat::Affine)
+		return 3 * sizeof(glm::vec4);
+	return 2 * sizeof(glm::vec4);
+}
+
+bool HasUniformScale(const glm::mat4& transform) {
+	glm::vec3 x = transform[0];
+	glm::vec3 y = transform[1];
+	glm::vec3 z = transform[2];
+
+	float xx = glm::dot(x, x);
+	float tolerance = xx * 1e-4f;
+	return glm::abs(glm::dot(y, y) - xx) <= tolerance
+		&& glm::abs(glm::dot(z, z) - xx) <= tolerance
+		&& glm::abs(glm::dot(x, y)) <= tolerance
+		&& glm::abs(glm::dot(x, z)) <= tolerance
+		&& glm::abs(glm::dot(y, z)) <= tolerance;
+}
+
+bool Encode(InstanceFormat format, const glm::mat4* transforms,
+			uint64_t count, void* out)
+{
+	bool uniform = true;
+	auto* dst = static_cast<glm::vec4*>(out);
+
+	for(uint64_t i = 0; i < count; i++) {
+		const glm::mat4& tr = transforms[i];
+		uniform &= HasUniformScale(tr);
+
+		if(format == InstanceFormat::Matrix) {
+			std::memcpy(dst, &tr, sizeof(glm::mat4));
+			dst += 4;
+		}
+		else if(format == InstanceFormat::Affine) {
+			for(uint32_t row = 0; row < 3; row++)
+				*dst++ = glm::vec4(tr[0][row], tr[1][row], tr[2][row],
+								   tr[3][row]);
+		}
+		else {
+			glm::mat3 basis(tr);
+			// Keeps the volume, and a mirror as a negative scale
+			float det = glm::determinant(basis);
+			float scale = glm::sign(det) * glm::pow(glm::abs(det), 1 / 3.0f);
+			if(scale == 0.0f)
+				scale = 1.0f;
+
+			glm::quat rotation = glm::normalize(glm::quat_cast(basis / scale));
+			*dst++ = glm::vec4(glm::vec3(tr[3]), scale);
+			*dst++ = glm::vec4(rotation.x, rotation.y, rotation.z, rotation.w);
+		}
+	}
+
+	return uniform;
+}
+
+}
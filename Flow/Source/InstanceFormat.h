@@ -0,0 +1,38 @@
+#pragma once
+
+#include <VolcaniCore/Core/Defines.h>
+#include <VolcaniCore/Core/Math.h>
+
+#include "Graphics/RendererAPI.h"
+
+using namespace VolcaniCore;
+
+namespace Magma::Graphics {
+
+// How a mesh instance's transform is laid out in the instance buffer.
+// Shaders read up to four vec4 from location 3 on and decode them by
+// u_InstanceFormat, slots a format doesn't use read as zero.
+enum class InstanceFormat : uint8_t {
+	Matrix, // 64 bytes, the full mat4
+	Affine, // 48 bytes, the top three rows
+	TRS		// 32 bytes, position, uniform scale and a rotation quaternion
+};
+
+namespace Instances {
+
+BufferLayout GetLayout(InstanceFormat format);
+uint64_t GetStride(InstanceFormat format);
+
+// True when the upper 3x3 is a rotation times one scale, so its normals
+// need no inverse transpose
+bool HasUniformScale(const glm::mat4& transform);
+
+// Writes count instances to out, GetStride(format) bytes apart.
+// Returns whether every transform has a uniform scale. TRS can't hold
+// any other, those instances get the average scale
+bool Encode(InstanceFormat format, const glm::mat4* transforms,
+			uint64_t count, void* out);
+
+}
+
+}
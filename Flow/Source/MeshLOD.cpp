@@ -0,0 +1,385 @@
+#include "MeshLOD.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <map>
+#include <queue>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+using namespace VolcaniCore;
+
+namespace Magma::Graphics {
+
+const uint32_t MeshLOD::MaxLevels = 8;
+const float MeshLOD::Hysteresis = 0.25f;
+
+// Sum of squared distances to a set of planes, the symmetric 4x4 matrix
+// stored as its upper triangle
+struct Quadric {
+	double A[10] = { };
+
+	void AddPlane(const glm::vec3& normal, const glm::vec3& point) {
+		double a = normal.x, b = normal.y, c = normal.z;
+		double d = -glm::dot(normal, point);
+		A[0] += a * a; A[1] += a * b; A[2] += a * c; A[3] += a * d;
+		A[4] += b * b; A[5] += b * c; A[6] += b * d;
+		A[7] += c * c; A[8] += c * d;
+		A[9] += d * d;
+	}
+
+	Quadric& operator +=(const Quadric& other) {
+		for(uint32_t i = 0; i < 10; i++)
+			A[i] += other.A[i];
+		return *this;
+	}
+
+	double Evaluate(const glm::vec3& p) const {
+		double x = p.x, y = p.y, z = p.z;
+		return A[0] * x * x + 2.0 * A[1] * x * y + 2.0 * A[2] * x * z
+			 + 2.0 * A[3] * x + A[4] * y * y + 2.0 * A[5] * y * z
+			 + 2.0 * A[6] * y + A[7] * z * z + 2.0 * A[8] * z + A[9];
+	}
+};
+
+struct Collapse {
+	float Cost;
+	uint32_t From;
+	uint32_t To;
+	uint32_t FromVersion;
+	uint32_t ToVersion;
+
+	bool operator >(const Collapse& other) const {
+		return Cost > other.Cost;
+	}
+};
+
+static uint64_t EdgeKey(uint32_t a, uint32_t b) {
+	return a < b ? (uint64_t)a << 32 | b : (uint64_t)b << 32 | a;
+}
+
+MeshLOD::MeshLOD(Ref<Mesh> mesh, const LODSettings& settings) {
+	glm::vec3 min = glm::vec3(FLT_MAX);
+	glm::vec3 max = glm::vec3(-FLT_MAX);
+	LODLevel full;
+	for(auto& subMesh : mesh->SubMeshes) {
+		for(auto& vertex : subMesh.Vertices) {
+			min = glm::min(min, vertex.Position);
+			max = glm::max(max, vertex.Position);
+		}
+		full.Triangles += subMesh.Indices.Count() / 3;
+	}
+	m_Levels.Add(full);
+
+	if(min.x <= max.x) {
+		m_Center = (min + max) * 0.5f;
+		for(auto& subMesh : mesh->SubMeshes)
+			for(auto& vertex : subMesh.Vertices) {
+				float distance = glm::distance(m_Center, vertex.Position);
+				m_Radius = std::max(m_Radius, distance);
+			}
+	}
+
+	uint32_t levels = std::min(settings.Levels, MaxLevels - 1);
+	float ratio = 1.0f;
+	for(uint32_t i = 0; i < levels; i++) {
+		uint64_t previous = m_Levels[-1].Triangles;
+		if(previous < settings.MinTriangles)
+			break;
+
+		ratio *= settings.Reduction;
+		LODLevel level;
+		for(auto& source : mesh->SubMeshes) {
+			uint64_t target = uint64_t(source.Indices.Count() / 3 * ratio) * 3;
+			List<uint32_t> indices;
+			float error =
+				Simplify(source.Vertices, source.Indices, target, indices);
+			level.Error = std::max(level.Error, error);
+
+			// Only the vertices still in use are kept
+			SubMesh lod = source;
+			lod.Vertices.Clear();
+			lod.Indices.Clear();
+			std::vector<uint32_t> remap(source.Vertices.Count(), UINT32_MAX);
+			for(uint32_t index : indices) {
+				if(remap[index] == UINT32_MAX) {
+					remap[index] = (uint32_t)lod.Vertices.Count();
+					lod.Vertices.Add(source.Vertices[index]);
+				}
+				lod.Indices.Add(remap[index]);
+			}
+
+			level.Triangles += lod.Indices.Count() / 3;
+			level.SubMeshes.Add(lod);
+		}
+
+		// Not worth a level of its own
+		if(level.Triangles * 10 > previous * 9)
+			break;
+
+		// Select relies on the error growing with the level
+		level.Error = std::max(level.Error, m_Levels[-1].Error);
+		m_Levels.Add(level);
+	}
+}
+
+uint32_t MeshLOD::Select(float pixelsPerUnit, float maxError,
+						 int32_t previous) const
+{
+	uint32_t level = 0;
+	for(uint32_t i = 1; i < m_Levels.Count(); i++)
+		if(m_Levels[i].Error * pixelsPerUnit <= maxError)
+			level = i;
+
+	if(previous < 0 || (uint32_t)previous >= m_Levels.Count())
+		return level;
+
+	// Coarser once well under the limit, finer once well over it
+	uint32_t last = previous;
+	if(level > last) {
+		float limit = maxError * (1.0f - Hysteresis);
+		while(level > last && m_Levels[level].Error * pixelsPerUnit > limit)
+			level--;
+	}
+	else if(level < last) {
+		float limit = maxError * (1.0f + Hysteresis);
+		if(m_Levels[last].Error * pixelsPerUnit <= limit)
+			level = last;
+	}
+
+	return level;
+}
+
+float MeshLOD::Simplify(const List<Vertex>& vertices,
+						const List<uint32_t>& indices, uint64_t targetCount,
+						List<uint32_t>& out)
+{
+	out.Clear();
+
+	// Vertices split along seams share a position. The surface collapses
+	// by position, corners pick one of its vertices afterwards
+	std::map<std::tuple<float, float, float>, uint32_t> positionIndices;
+	std::vector<uint32_t> vertexClass(vertices.Count());
+	std::vector<glm::vec3> positions;
+	std::vector<std::vector<uint32_t>> classVertices;
+	for(uint64_t i = 0; i < vertices.Count(); i++) {
+		const glm::vec3& p = vertices[i].Position;
+		auto [it, added] =
+			positionIndices
+			.insert({ { p.x, p.y, p.z }, (uint32_t)positions.size() });
+		if(added) {
+			positions.push_back(p);
+			classVertices.emplace_back();
+		}
+
+		vertexClass[i] = it->second;
+		classVertices[it->second].push_back((uint32_t)i);
+	}
+
+	uint64_t classCount = positions.size();
+	std::vector<uint32_t> triangles;
+	std::vector<uint32_t> corners;
+	std::vector<Quadric> quadrics(classCount);
+	std::unordered_map<uint64_t, uint32_t> edges;
+	for(uint64_t i = 0; i + 2 < indices.Count(); i += 3) {
+		uint32_t c[3];
+		for(uint32_t j = 0; j < 3; j++)
+			c[j] = vertexClass[indices[i + j]];
+		if(c[0] == c[1] || c[1] == c[2] || c[2] == c[0])
+			continue;
+
+		glm::vec3 normal =
+			glm::cross(positions[c[1]] - positions[c[0]],
+					   positions[c[2]] - positions[c[0]]);
+		float length = glm::length(normal);
+		if(length > 0.0f)
+			for(uint32_t j = 0; j < 3; j++)
+				quadrics[c[j]].AddPlane(normal / length, positions[c[0]]);
+
+		for(uint32_t j = 0; j < 3; j++) {
+			triangles.push_back(c[j]);
+			corners.push_back(indices[i + j]);
+			edges[EdgeKey(c[j], c[(j + 1) % 3])]++;
+		}
+	}
+
+	uint64_t triangleCount = triangles.size() / 3;
+	std::vector<std::vector<uint32_t>> around(classCount);
+	for(uint64_t t = 0; t < triangleCount; t++)
+		for(uint32_t j = 0; j < 3; j++)
+			around[triangles[t * 3 + j]].push_back((uint32_t)t);
+
+	// Borders are held in place by planes standing on their edges, and
+	// their vertices only ever slide along them
+	std::vector<bool> border(classCount, false);
+	for(uint64_t t = 0; t < triangleCount; t++) {
+		const uint32_t* c = &triangles[t * 3];
+		glm::vec3 normal =
+			glm::cross(positions[c[1]] - positions[c[0]],
+					   positions[c[2]] - positions[c[0]]);
+
+		for(uint32_t j = 0; j < 3; j++) {
+			uint32_t a = c[j], b = c[(j + 1) % 3];
+			if(edges[EdgeKey(a, b)] != 1)
+				continue;
+
+			border[a] = border[b] = true;
+			glm::vec3 side = glm::cross(normal, positions[b] - positions[a]);
+			float length = glm::length(side);
+			if(length > 0.0f) {
+				quadrics[a].AddPlane(side / length, positions[a]);
+				quadrics[b].AddPlane(side / length, positions[a]);
+			}
+		}
+	}
+
+	std::vector<bool> dead(triangleCount, false);
+	std::vector<bool> removed(classCount, false);
+	std::vector<uint32_t> versions(classCount, 0);
+	std::priority_queue<Collapse, std::vector<Collapse>,
+						std::greater<Collapse>> queue;
+
+	auto canCollapse =
+		[&](uint32_t from, uint32_t to) -> bool
+		{
+			if(!border[from])
+				return true;
+			auto found = edges.find(EdgeKey(from, to));
+			return border[to] && found != edges.end() && found->second == 1;
+		};
+
+	auto push =
+		[&](uint32_t a, uint32_t b)
+		{
+			Quadric q = quadrics[a];
+			q += quadrics[b];
+
+			// Onto whichever end moves the surface less
+			double toB = canCollapse(a, b) ? q.Evaluate(positions[b]) : DBL_MAX;
+			double toA = canCollapse(b, a) ? q.Evaluate(positions[a]) : DBL_MAX;
+			if(toA == DBL_MAX && toB == DBL_MAX)
+				return;
+
+			if(toB <= toA)
+				queue.push({ (float)toB, a, b, versions[a], versions[b] });
+			else
+				queue.push({ (float)toA, b, a, versions[b], versions[a] });
+		};
+
+	for(auto& [key, count] : edges)
+		push(uint32_t(key >> 32), uint32_t(key));
+
+	// Whether moving from to where to is turns any triangle over
+	auto flips =
+		[&](uint32_t from, uint32_t to) -> bool
+		{
+			for(uint32_t t : around[from]) {
+				const uint32_t* c = &triangles[t * 3];
+				if(dead[t] || c[0] == to || c[1] == to || c[2] == to)
+					continue;
+
+				glm::vec3 p[3], q[3];
+				for(uint32_t j = 0; j < 3; j++) {
+					p[j] = positions[c[j]];
+					q[j] = c[j] == from ? positions[to] : p[j];
+				}
+
+				glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+				glm::vec3 after = glm::cross(q[1] - q[0], q[2] - q[0]);
+				if(glm::dot(before, after) <= 0.0f)
+					return true;
+			}
+
+			return false;
+		};
+
+	float error = 0.0f;
+	uint64_t live = triangleCount;
+	while(live * 3 > targetCount && !queue.empty()) {
+		Collapse collapse = queue.top();
+		queue.pop();
+
+		uint32_t from = collapse.From;
+		uint32_t to = collapse.To;
+		if(removed[from] || removed[to]
+		|| versions[from] != collapse.FromVersion
+		|| versions[to] != collapse.ToVersion)
+			continue;
+		if(flips(from, to))
+			continue;
+
+		for(uint32_t t : around[from]) {
+			if(dead[t])
+				continue;
+
+			uint32_t* c = &triangles[t * 3];
+			if(c[0] == to || c[1] == to || c[2] == to) {
+				dead[t] = true;
+				live--;
+				continue;
+			}
+
+			for(uint32_t j = 0; j < 3; j++) {
+				if(c[j] != from)
+					continue;
+
+				// The border edges of from now end at to
+				for(uint32_t k : { (j + 1) % 3, (j + 2) % 3 }) {
+					auto found = edges.find(EdgeKey(from, c[k]));
+					if(found != edges.end() && found->second == 1)
+						edges.insert({ EdgeKey(to, c[k]), 1 });
+				}
+				c[j] = to;
+			}
+			around[to].push_back(t);
+		}
+
+		quadrics[to] += quadrics[from];
+		removed[from] = true;
+		around[from].clear();
+		versions[to]++;
+		error = std::max(error, std::sqrt(std::max(collapse.Cost, 0.0f)));
+
+		auto& list = around[to];
+		list.erase(
+			std::remove_if(list.begin(), list.end(),
+				[&](uint32_t t) { return dead[t]; }),
+			list.end());
+
+		for(uint32_t t : list)
+			for(uint32_t j = 0; j < 3; j++)
+				if(triangles[t * 3 + j] != to)
+					push(to, triangles[t * 3 + j]);
+	}
+
+	// Each corner keeps its vertex, or takes the vertex at its new
+	// position that faces the same way most
+	for(uint64_t t = 0; t < triangleCount; t++) {
+		if(dead[t])
+			continue;
+
+		for(uint32_t j = 0; j < 3; j++) {
+			uint32_t vertex = corners[t * 3 + j];
+			uint32_t position = triangles[t * 3 + j];
+			if(vertexClass[vertex] != position) {
+				const glm::vec3& normal = vertices[vertex].Normal;
+				float best = -FLT_MAX;
+				for(uint32_t candidate : classVertices[position]) {
+					float facing = glm::dot(normal, vertices[candidate].Normal);
+					if(facing > best) {
+						best = facing;
+						vertex = candidate;
+					}
+				}
+			}
+
+			out.Add(vertex);
+		}
+	}
+
+	return error;
+}
+
+}
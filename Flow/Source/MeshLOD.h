@@ -0,0 +1,71 @@
+#pragma once
+
+#include <VolcaniCore/Core/Defines.h>
+#include <VolcaniCore/Core/Math.h>
+
+#include "Graphics/Mesh.h"
+
+using namespace VolcaniCore;
+
+namespace Magma::Graphics {
+
+struct LODSettings {
+	uint32_t Levels = 4; // Besides the mesh itself
+	float Reduction = 0.5f; // Triangles a level keeps of the one before
+	uint64_t MinTriangles = 64; // Fewer than this stops the chain
+};
+
+struct LODLevel {
+	// In the order of the mesh's submeshes, empty for level 0
+	List<SubMesh> SubMeshes;
+	// Mesh units, the furthest the surface moved from the full mesh
+	float Error = 0.0f;
+	uint64_t Triangles = 0;
+};
+
+// Coarser copies of a mesh made by quadric error edge collapse, level 0
+// being the mesh itself. Built once, on the CPU only, usually when the
+// mesh is imported. Submeshes are simplified on their own, so materials
+// and the submesh order stay the same on every level.
+class MeshLOD {
+public:
+	MeshLOD(Ref<Mesh> mesh, const LODSettings& settings = { });
+	~MeshLOD() = default;
+
+	MeshLOD(const MeshLOD&) = delete;
+	MeshLOD& operator =(const MeshLOD&) = delete;
+
+	uint32_t GetLevelCount() const { return m_Levels.Count(); }
+	LODLevel& GetLevel(uint32_t level) { return m_Levels[level]; }
+	const LODLevel& GetLevel(uint32_t level) const { return m_Levels[level]; }
+
+	// Bounding sphere of the full mesh
+	const glm::vec3& GetCenter() const { return m_Center; }
+	float GetRadius() const { return m_Radius; }
+
+	// The coarsest level whose error stays under maxError pixels, with
+	// pixelsPerUnit the size of one mesh unit on screen. A previous level
+	// is kept until the error moves past it by more than Hysteresis, so
+	// instances near a boundary don't switch every frame
+	uint32_t Select(float pixelsPerUnit, float maxError,
+					int32_t previous = -1) const;
+
+	// Keeps at most targetCount indices, less only when the surface can't
+	// be collapsed any further. out holds indices into vertices, the error
+	// in the units of the positions is returned
+	static float Simplify(const List<Vertex>& vertices,
+						  const List<uint32_t>& indices, uint64_t targetCount,
+						  List<uint32_t>& out);
+
+	// Levels a chain can have, the mesh itself included
+	static const uint32_t MaxLevels;
+	// Fraction of maxError Select waits for before switching
+	static const float Hysteresis;
+
+private:
+	List<LODLevel> m_Levels;
+	glm::vec3 m_Center = glm::vec3(0.0f);
+	float m_Radius = 0.0f;
+};
+
+}
@@ -0,0 +1,316 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace VolcaniCore;
+
+namespace Magma::Graphics {
+
+const uint32_t MeshOptimizer::CacheSize = 16;
+
+// A FIFO cache, a vertex stays in it until CacheSize misses come after
+// its own
+struct VertexCache {
+	std::vector<uint64_t> Stamps;
+	uint64_t Time = MeshOptimizer::CacheSize + 1;
+
+	VertexCache(uint64_t vertexCount)
+		: Stamps(vertexCount, 0) { }
+
+	bool Miss(uint32_t v) {
+		if(Time - Stamps[v] <= MeshOptimizer::CacheSize)
+			return false;
+
+		Stamps[v] = Time++;
+		return true;
+	}
+
+	void Flush() {
+		Time += MeshOptimizer::CacheSize;
+	}
+};
+
+OptimizeStats MeshOptimizer::Optimize(Ref<Mesh> mesh,
+									  float overdrawThreshold)
+{
+	OptimizeStats stats;
+	double before = 0.0;
+	double after = 0.0;
+
+	List<uint32_t> clusters;
+	for(auto& subMesh : mesh->SubMeshes) {
+		auto& vertices = subMesh.Vertices;
+		auto& indices = subMesh.Indices;
+		uint64_t triangles = indices.Count() / 3;
+		if(!triangles)
+			continue;
+
+		stats.Triangles += triangles;
+		before += GetACMR(indices, vertices.Count()) * triangles;
+
+		clusters.Clear();
+		OptimizeVertexCache(indices, vertices.Count(), clusters);
+		OptimizeOverdraw(vertices, indices, clusters, overdrawThreshold);
+		OptimizeVertexFetch(vertices, indices);
+
+		after += GetACMR(indices, vertices.Count()) * triangles;
+	}
+
+	if(stats.Triangles) {
+		stats.ACMRBefore = float(before / stats.Triangles);
+		stats.ACMRAfter = float(after / stats.Triangles);
+	}
+	return stats;
+}
+
+void MeshOptimizer::OptimizeVertexCache(List<uint32_t>& indices,
+										uint64_t vertexCount,
+										List<uint32_t>& clusters)
+{
+	uint64_t triangleCount = indices.Count() / 3;
+
+	// The triangles around each vertex
+	std::vector<uint32_t> offsets(vertexCount + 1, 0);
+	for(uint64_t i = 0; i < triangleCount * 3; i++)
+		offsets[indices[i] + 1]++;
+	for(uint64_t v = 0; v < vertexCount; v++)
+		offsets[v + 1] += offsets[v];
+
+	std::vector<uint32_t> adjacency(triangleCount * 3);
+	std::vector<uint32_t> filled(offsets.begin(), offsets.end() - 1);
+	for(uint64_t i = 0; i < triangleCount * 3; i++)
+		adjacency[filled[indices[i]]++] = uint32_t(i / 3);
+
+	// Triangles of each vertex not emitted yet
+	std::vector<uint32_t> live(vertexCount);
+	for(uint64_t v = 0; v < vertexCount; v++)
+		live[v] = offsets[v + 1] - offsets[v];
+
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<uint32_t> deadEnds;
+	std::vector<uint32_t> candidates;
+	std::vector<uint32_t> order;
+	order.reserve(triangleCount);
+	VertexCache cache(vertexCount);
+
+	// Recently used vertices first, then the first with triangles left
+	uint64_t cursor = 0;
+	auto skipDeadEnd =
+		[&]() -> int64_t
+		{
+			while(!deadEnds.empty()) {
+				uint32_t v = deadEnds.back();
+				deadEnds.pop_back();
+				if(live[v])
+					return v;
+			}
+
+			for(; cursor < vertexCount; cursor++)
+				if(live[cursor])
+					return (int64_t)cursor;
+			return -1;
+		};
+
+	int64_t fan = skipDeadEnd();
+	if(fan >= 0)
+		clusters.Add(0);
+
+	while(fan >= 0) {
+		candidates.clear();
+		for(uint32_t k = offsets[fan]; k < offsets[fan + 1]; k++) {
+			uint32_t t = adjacency[k];
+			if(emitted[t])
+				continue;
+
+			for(uint32_t j = 0; j < 3; j++) {
+				uint32_t v = indices[t * 3 + j];
+				deadEnds.push_back(v);
+				candidates.push_back(v);
+				live[v]--;
+				cache.Miss(v);
+			}
+
+			emitted[t] = true;
+			order.push_back(t);
+		}
+
+		// The oldest vertex that is still cached after its own fan
+		int64_t next = -1;
+		int64_t best = -1;
+		for(uint32_t v : candidates) {
+			if(!live[v])
+				continue;
+
+			int64_t age = int64_t(cache.Time - cache.Stamps[v]);
+			int64_t priority = 0;
+			if(age + 2 * live[v] <= CacheSize)
+				priority = age;
+			if(priority > best) {
+				best = priority;
+				next = v;
+			}
+		}
+
+		if(next < 0) {
+			next = skipDeadEnd();
+			if(next >= 0)
+				clusters.Add((uint32_t)order.size());
+		}
+		fan = next;
+	}
+
+	std::vector<uint32_t> reordered;
+	reordered.reserve(indices.Count());
+	for(uint32_t t : order)
+		for(uint32_t j = 0; j < 3; j++)
+			reordered.push_back(indices[t * 3 + j]);
+
+	// Whatever doesn't make a whole triangle stays at the end
+	for(uint64_t i = 0; i < reordered.size(); i++)
+		indices[i] = reordered[i];
+}
+
+void MeshOptimizer::OptimizeOverdraw(const List<Vertex>& vertices,
+									 List<uint32_t>& indices,
+									 const List<uint32_t>& clusters,
+									 float threshold)
+{
+	uint64_t triangleCount = indices.Count() / 3;
+	if(!triangleCount || !clusters)
+		return;
+
+	float target =
+		GetACMR(indices, vertices.Count()) * std::max(threshold, 1.0f);
+
+	// More clusters where a run has made up for its cold start, so the
+	// order can change without costing more than threshold allows
+	std::vector<uint32_t> starts;
+	VertexCache cache(vertices.Count());
+	for(uint64_t c = 0; c < clusters.Count(); c++) {
+		uint64_t end =
+			c + 1 < clusters.Count() ? clusters[c + 1] : triangleCount;
+
+		starts.push_back(clusters[c]);
+		cache.Flush();
+		uint64_t misses = 0;
+		for(uint64_t t = clusters[c]; t < end; t++) {
+			for(uint32_t j = 0; j < 3; j++)
+				misses += cache.Miss(indices[t * 3 + j]);
+
+			uint64_t count = t + 1 - starts.back();
+			if(t + 1 < end && misses <= target * count) {
+				starts.push_back(uint32_t(t + 1));
+				cache.Flush();
+				misses = 0;
+			}
+		}
+	}
+
+	struct Cluster {
+		uint32_t Start;
+		uint32_t End;
+		float Sort;
+	};
+
+	std::vector<Cluster> sorted;
+	std::vector<glm::vec3> centers;
+	std::vector<glm::vec3> normals;
+	glm::vec3 center = glm::vec3(0.0f);
+	float area = 0.0f;
+	for(uint64_t c = 0; c < starts.size(); c++) {
+		uint32_t end =
+			c + 1 < starts.size() ? starts[c + 1] : (uint32_t)triangleCount;
+
+		glm::vec3 sum = glm::vec3(0.0f);
+		glm::vec3 normal = glm::vec3(0.0f);
+		float clusterArea = 0.0f;
+		for(uint32_t t = starts[c]; t < end; t++) {
+			const glm::vec3& p0 = vertices[indices[t * 3 + 0]].Position;
+			const glm::vec3& p1 = vertices[indices[t * 3 + 1]].Position;
+			const glm::vec3& p2 = vertices[indices[t * 3 + 2]].Position;
+			glm::vec3 cross = glm::cross(p1 - p0, p2 - p0);
+			float a = glm::length(cross);
+
+			sum += (p0 + p1 + p2) / 3.0f * a;
+			normal += cross;
+			clusterArea += a;
+		}
+
+		center += sum;
+		area += clusterArea;
+		sorted.push_back({ starts[c], end, 0.0f });
+		centers.push_back(clusterArea > 0.0f ? sum / clusterArea : sum);
+		normals.push_back(normal);
+	}
+
+	if(area > 0.0f)
+		center /= area;
+
+	for(uint64_t c = 0; c < sorted.size(); c++) {
+		float length = glm::length(normals[c]);
+		if(length > 0.0f)
+			sorted[c].Sort =
+				glm::dot(centers[c] - center, normals[c] / length);
+	}
+
+	std::stable_sort(sorted.begin(), sorted.end(),
+		[](const Cluster& a, const Cluster& b) -> bool
+		{
+			return a.Sort > b.Sort;
+		});
+
+	std::vector<uint32_t> reordered;
+	reordered.reserve(triangleCount * 3);
+	for(auto& cluster : sorted)
+		for(uint32_t t = cluster.Start; t < cluster.End; t++)
+			for(uint32_t j = 0; j < 3; j++)
+				reordered.push_back(indices[t * 3 + j]);
+
+	for(uint64_t i = 0; i < reordered.size(); i++)
+		indices[i] = reordered[i];
+}
+
+void MeshOptimizer::OptimizeVertexFetch(List<Vertex>& vertices,
+										List<uint32_t>& indices)
+{
+	uint64_t vertexCount = vertices.Count();
+	std::vector<uint32_t> remap(vertexCount, UINT32_MAX);
+	std::vector<uint32_t> order;
+	order.reserve(vertexCount);
+
+	for(uint64_t i = 0; i < indices.Count(); i++) {
+		uint32_t& v = indices[i];
+		if(remap[v] == UINT32_MAX) {
+			remap[v] = (uint32_t)order.size();
+			order.push_back(v);
+		}
+		v = remap[v];
+	}
+
+	// Vertices no index uses are kept, after the others
+	for(uint64_t v = 0; v < vertexCount; v++)
+		if(remap[v] == UINT32_MAX)
+			order.push_back((uint32_t)v);
+
+	List<Vertex> reordered(vertexCount);
+	for(uint32_t v : order)
+		reordered.Add(vertices[v]);
+	vertices = std::move(reordered);
+}
+
+float MeshOptimizer::GetACMR(const List<uint32_t>& indices,
+							 uint64_t vertexCount)
+{
+	uint64_t triangleCount = indices.Count() / 3;
+	if(!triangleCount)
+		return 0.0f;
+
+	VertexCache cache(vertexCount);
+	uint64_t misses = 0;
+	for(uint64_t i = 0; i < triangleCount * 3; i++)
+		misses += cache.Miss(indices[i]);
+	return float(misses) / triangleCount;
+}
+
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <VolcaniCore/Core/Defines.h>
+#include <VolcaniCore/Core/Math.h>
+
+#include "Graphics/Mesh.h"
+
+using namespace VolcaniCore;
+
+namespace Magma::Graphics {
+
+struct OptimizeStats {
+	uint64_t Triangles = 0;
+	// Average cache miss ratio, vertices transformed per triangle with a
+	// FIFO cache of MeshOptimizer::CacheSize vertices
+	float ACMRBefore = 0.0f;
+	float ACMRAfter = 0.0f;
+};
+
+// Reorders the triangles and vertices of a mesh's submeshes so the GPU
+// transforms and fetches fewer vertices and shades fewer hidden pixels.
+// CPU only and renderer independent, meant to run once when a mesh is
+// imported or cooked. What is drawn stays the same.
+class MeshOptimizer {
+public:
+	// Every step below, in order, on every submesh. overdrawThreshold is
+	// how much worse than the vertex cache order a cluster's miss ratio
+	// may get for the sake of overdraw, 1 or more
+	static OptimizeStats Optimize(Ref<Mesh> mesh,
+								  float overdrawThreshold = 1.05f);
+
+	// Tipsify, fanning around vertices still in the cache. clusters gets
+	// the first triangle of every run that had to start from a cold cache
+	static void OptimizeVertexCache(List<uint32_t>& indices,
+									uint64_t vertexCount,
+									List<uint32_t>& clusters);
+
+	// Splits the triangles into clusters, from the ones of
+	// OptimizeVertexCache, and puts the clusters facing away from the
+	// center of the submesh first. Those tend to hide the others from any
+	// direction
+	static void OptimizeOverdraw(const List<Vertex>& vertices,
+								 List<uint32_t>& indices,
+								 const List<uint32_t>& clusters,
+								 float threshold);
+
+	// Orders vertices by their first use, indices follow them
+	static void OptimizeVertexFetch(List<Vertex>& vertices,
+									List<uint32_t>& indices);
+
+	static float GetACMR(const List<uint32_t>& indices, uint64_t vertexCount);
+
+	static const uint32_t CacheSize;
+};
+
+}
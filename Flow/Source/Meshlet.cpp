@@ -0,0 +1,321 @@
+#include "Meshlet.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+using namespace VolcaniCore;
+
+namespace Magma::Graphics {
+
+Frustum::Frustum(const glm::mat4& viewProj) {
+	glm::vec4 rows[4];
+	for(uint32_t i = 0; i < 4; i++)
+		rows[i] =
+			glm::vec4(viewProj[0][i], viewProj[1][i],
+					  viewProj[2][i], viewProj[3][i]);
+
+	Planes[0] = rows[3] + rows[0];
+	Planes[1] = rows[3] - rows[0];
+	Planes[2] = rows[3] + rows[1];
+	Planes[3] = rows[3] - rows[1];
+	Planes[4] = rows[3] + rows[2];
+	Planes[5] = rows[3] - rows[2];
+	for(auto& plane : Planes)
+		plane /= glm::length(glm::vec3(plane));
+}
+
+bool Frustum::Intersects(const glm::vec3& center, float radius) const {
+	for(auto& plane : Planes)
+		if(glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+			return false;
+	return true;
+}
+
+bool Frustum::Contains(const glm::vec3& center, float radius) const {
+	for(auto& plane : Planes)
+		if(glm::dot(glm::vec3(plane), center) + plane.w < radius)
+			return false;
+	return true;
+}
+
+MeshletSet::MeshletSet(Ref<Mesh> mesh, uint32_t maxTriangles,
+					   uint32_t maxVertices)
+{
+	glm::vec3 min = glm::vec3(FLT_MAX);
+	glm::vec3 max = glm::vec3(-FLT_MAX);
+	for(auto& subMesh : mesh->SubMeshes) {
+		auto meshlets =
+			Build(subMesh.Vertices, subMesh.Indices, maxTriangles, maxVertices);
+		m_Count += meshlets.Count();
+		for(auto& meshlet : meshlets) {
+			m_Triangles += meshlet.IndexCount / 3;
+			min = glm::min(min, meshlet.Center - glm::vec3(meshlet.Radius));
+			max = glm::max(max, meshlet.Center + glm::vec3(meshlet.Radius));
+		}
+		m_Meshlets.Add(meshlets);
+	}
+
+	if(!m_Count)
+		return;
+
+	m_Center = (min + max) * 0.5f;
+	for(auto& meshlets : m_Meshlets)
+		for(auto& meshlet : meshlets)
+			m_Radius =
+				std::max(m_Radius,
+						 glm::distance(m_Center, meshlet.Center)
+						 + meshlet.Radius);
+}
+
+// Bounding sphere and normal cone of the triangles from first
+static void SetBounds(Meshlet& meshlet, const List<Vertex>& vertices,
+					  const std::vector<uint32_t>& indices, uint64_t first)
+{
+	glm::vec3 min = glm::vec3(FLT_MAX);
+	glm::vec3 max = glm::vec3(-FLT_MAX);
+	for(uint64_t i = first; i < first + meshlet.IndexCount; i++) {
+		min = glm::min(min, vertices[indices[i]].Position);
+		max = glm::max(max, vertices[indices[i]].Position);
+	}
+
+	meshlet.Center = (min + max) * 0.5f;
+	meshlet.Radius = 0.0f;
+	for(uint64_t i = first; i < first + meshlet.IndexCount; i++) {
+		const glm::vec3& p = vertices[indices[i]].Position;
+		meshlet.Radius =
+			std::max(meshlet.Radius, glm::distance(meshlet.Center, p));
+	}
+
+	std::vector<glm::vec3> normals;
+	glm::vec3 sum = glm::vec3(0.0f);
+	for(uint64_t i = first; i < first + meshlet.IndexCount; i += 3) {
+		const glm::vec3& p0 = vertices[indices[i + 0]].Position;
+		const glm::vec3& p1 = vertices[indices[i + 1]].Position;
+		const glm::vec3& p2 = vertices[indices[i + 2]].Position;
+		glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+		float length = glm::length(normal);
+		if(length == 0.0f)
+			continue;
+
+		normals.push_back(normal / length);
+		sum += normals.back();
+	}
+
+	// Never culled by the cone when the triangles face too many ways
+	meshlet.ConeApex = meshlet.Center;
+	meshlet.ConeAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+	meshlet.ConeCutoff = 1.0f;
+
+	float length = glm::length(sum);
+	if(length == 0.0f)
+		return;
+
+	glm::vec3 axis = sum / length;
+	float spread = 1.0f;
+	for(auto& normal : normals)
+		spread = std::min(spread, glm::dot(axis, normal));
+	if(spread <= 0.1f)
+		return;
+
+	// Moved back along the axis until it is behind every triangle
+	float back = 0.0f;
+	uint64_t n = 0;
+	for(uint64_t i = first; i < first + meshlet.IndexCount; i += 3) {
+		const glm::vec3& p0 = vertices[indices[i + 0]].Position;
+		const glm::vec3& p1 = vertices[indices[i + 1]].Position;
+		const glm::vec3& p2 = vertices[indices[i + 2]].Position;
+		if(glm::length(glm::cross(p1 - p0, p2 - p0)) == 0.0f)
+			continue;
+
+		const glm::vec3& normal = normals[n++];
+		float t = glm::dot(meshlet.Center - p0, normal)
+				/ glm::dot(axis, normal);
+		back = std::max(back, t);
+	}
+
+	meshlet.ConeApex = meshlet.Center - axis * back;
+	meshlet.ConeAxis = axis;
+	meshlet.ConeCutoff = std::sqrt(1.0f - spread * spread);
+}
+
+List<Meshlet> MeshletSet::Build(const List<Vertex>& vertices,
+								List<uint32_t>& indices,
+								uint32_t maxTriangles, uint32_t maxVertices)
+{
+	uint64_t vertexCount = vertices.Count();
+	uint64_t triangleCount = indices.Count() / 3;
+	maxTriangles = std::max(maxTriangles, 1u);
+	maxVertices = std::max(maxVertices, 3u);
+
+	// The triangles around each vertex
+	std::vector<uint32_t> offsets(vertexCount + 1, 0);
+	for(uint64_t i = 0; i < triangleCount * 3; i++)
+		offsets[indices[i] + 1]++;
+	for(uint64_t v = 0; v < vertexCount; v++)
+		offsets[v + 1] += offsets[v];
+
+	std::vector<uint32_t> adjacency(triangleCount * 3);
+	std::vector<uint32_t> filled(offsets.begin(), offsets.end() - 1);
+	for(uint64_t i = 0; i < triangleCount * 3; i++)
+		adjacency[filled[indices[i]]++] = uint32_t(i / 3);
+
+	std::vector<bool> used(triangleCount, false);
+	std::vector<uint32_t> stamp(vertexCount, UINT32_MAX);
+	std::vector<uint32_t> candidates;
+	std::vector<uint32_t> order;
+	order.reserve(triangleCount * 3);
+
+	List<Meshlet> meshlets;
+	uint64_t next = 0;
+	uint32_t seed = 0;
+	bool hasSeed = false;
+	while(true) {
+		// Starts next to the meshlet before when it can
+		if(!hasSeed) {
+			while(next < triangleCount && used[next])
+				next++;
+			if(next == triangleCount)
+				break;
+			seed = (uint32_t)next;
+		}
+
+		uint32_t id = (uint32_t)meshlets.Count();
+		uint32_t vertexTotal = 0;
+		uint32_t triangles = 0;
+		candidates.clear();
+
+		auto newVertices =
+			[&](uint32_t t) -> uint32_t
+			{
+				uint32_t count = 0;
+				for(uint32_t j = 0; j < 3; j++)
+					count += stamp[indices[t * 3 + j]] != id;
+				return count;
+			};
+
+		auto add =
+			[&](uint32_t t)
+			{
+				used[t] = true;
+				triangles++;
+				for(uint32_t j = 0; j < 3; j++) {
+					uint32_t v = indices[t * 3 + j];
+					order.push_back(v);
+					if(stamp[v] == id)
+						continue;
+
+					stamp[v] = id;
+					vertexTotal++;
+					for(uint32_t k = offsets[v]; k < offsets[v + 1]; k++)
+						if(!used[adjacency[k]])
+							candidates.push_back(adjacency[k]);
+				}
+			};
+
+		Meshlet meshlet;
+		meshlet.IndexStart = (uint32_t)order.size();
+		add(seed);
+
+		// Grows by the neighbour adding the fewest vertices
+		while(triangles < maxTriangles) {
+			int64_t best = -1;
+			uint32_t bestCount = 4;
+			for(uint64_t i = 0; i < candidates.size(); ) {
+				if(used[candidates[i]]) {
+					candidates[i] = candidates.back();
+					candidates.pop_back();
+					continue;
+				}
+
+				uint32_t count = newVertices(candidates[i]);
+				if(count < bestCount) {
+					best = candidates[i];
+					bestCount = count;
+				}
+				i++;
+			}
+
+			if(best < 0 || vertexTotal + bestCount > maxVertices)
+				break;
+			add((uint32_t)best);
+		}
+
+		hasSeed = false;
+		for(uint32_t t : candidates)
+			if(!used[t]) {
+				seed = t;
+				hasSeed = true;
+				break;
+			}
+
+		meshlet.IndexCount = triangles * 3;
+		SetBounds(meshlet, vertices, order, meshlet.IndexStart);
+		meshlets.Add(meshlet);
+	}
+
+	// Whatever doesn't make a whole triangle stays at the end
+	for(uint64_t i = triangleCount * 3; i < indices.Count(); i++)
+		order.push_back(indices[i]);
+	for(uint64_t i = 0; i < order.size(); i++)
+		indices[i] = order[i];
+
+	return meshlets;
+}
+
+MeshletCullStats MeshletSet::Cull(const List<Meshlet>& meshlets,
+								  const glm::mat4& tr, const Frustum& frustum,
+								  const glm::vec3& camera,
+								  List<MeshletRange>& out)
+{
+	glm::vec3 scales =
+		glm::vec3(glm::length(glm::vec3(tr[0])),
+				  glm::length(glm::vec3(tr[1])),
+				  glm::length(glm::vec3(tr[2])));
+	float scale = std::max(scales.x, std::max(scales.y, scales.z));
+
+	// Cones only survive rotation and uniform scale, a mirror turns the
+	// triangles around
+	glm::mat3 rotation = glm::mat3(tr);
+	bool cones = glm::determinant(rotation) > 0.0f
+			  && std::min(scales.x, std::min(scales.y, scales.z))
+			   > scale * 0.99f;
+
+	MeshletCullStats stats;
+	uint64_t first = out.Count();
+	for(auto& meshlet : meshlets) {
+		uint64_t triangles = meshlet.IndexCount / 3;
+		stats.Meshlets++;
+		stats.Triangles += triangles;
+
+		glm::vec3 center = tr * glm::vec4(meshlet.Center, 1.0f);
+		bool visible = frustum.Intersects(center, meshlet.Radius * scale);
+		if(visible && cones && meshlet.ConeCutoff < 1.0f) {
+			glm::vec3 apex = tr * glm::vec4(meshlet.ConeApex, 1.0f);
+			glm::vec3 axis = rotation * meshlet.ConeAxis / scale;
+			glm::vec3 view = glm::normalize(apex - camera);
+			visible = glm::dot(view, axis) < meshlet.ConeCutoff;
+		}
+
+		if(!visible) {
+			stats.Culled++;
+			stats.CulledTriangles += triangles;
+			continue;
+		}
+
+		if(out.Count() > first) {
+			auto& last = out[-1];
+			if(last.IndexStart + last.IndexCount == meshlet.IndexStart) {
+				last.IndexCount += meshlet.IndexCount;
+				continue;
+			}
+		}
+
+		out.Add({ meshlet.IndexStart, meshlet.IndexCount });
+	}
+
+	return stats;
+}
+
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <VolcaniCore/Core/Defines.h>
+#include <VolcaniCore/Core/Math.h>
+
+#include "Graphics/Mesh.h"
+
+using namespace VolcaniCore;
+
+namespace Magma::Graphics {
+
+// The six planes of a view projection matrix, facing inwards
+struct Frustum {
+	glm::vec4 Planes[6];
+
+	Frustum(const glm::mat4& viewProj);
+
+	bool Intersects(const glm::vec3& center, float radius) const;
+	// The whole sphere is inside
+	bool Contains(const glm::vec3& center, float radius) const;
+};
+
+// A few dozen neighbouring triangles of a submesh, its indices a range of
+// the submesh's own
+struct Meshlet {
+	uint32_t IndexStart = 0;
+	uint32_t IndexCount = 0;
+
+	glm::vec3 Center;
+	float Radius;
+
+	// Every triangle faces away from a camera for which
+	// dot(normalize(ConeApex - camera), ConeAxis) >= ConeCutoff
+	glm::vec3 ConeApex;
+	glm::vec3 ConeAxis;
+	float ConeCutoff;
+};
+
+// Indices of a submesh, from IndexStart
+struct MeshletRange {
+	uint32_t IndexStart;
+	uint32_t IndexCount;
+};
+
+struct MeshletCullStats {
+	uint64_t Meshlets = 0;
+	uint64_t Culled = 0;
+	uint64_t Triangles = 0;
+	uint64_t CulledTriangles = 0;
+
+	MeshletCullStats& operator +=(const MeshletCullStats& other) {
+		Meshlets += other.Meshlets;
+		Culled += other.Culled;
+		Triangles += other.Triangles;
+		CulledTriangles += other.CulledTriangles;
+		return *this;
+	}
+};
+
+// The submeshes of a mesh split into meshlets, so the parts of a large mesh
+// that are off screen or facing away can be left out. Built and culled on
+// the CPU only.
+class MeshletSet {
+public:
+	// Reorders the indices of every submesh so the triangles of a meshlet
+	// are next to each other, and neighbouring meshlets mostly are too
+	MeshletSet(Ref<Mesh> mesh, uint32_t maxTriangles = 124,
+			   uint32_t maxVertices = 64);
+	~MeshletSet() = default;
+
+	MeshletSet(const MeshletSet&) = delete;
+	MeshletSet& operator =(const MeshletSet&) = delete;
+
+	const List<Meshlet>& GetMeshlets(uint64_t subMesh) const {
+		return m_Meshlets[subMesh];
+	}
+	uint64_t GetMeshletCount() const { return m_Count; }
+	uint64_t GetTriangleCount() const { return m_Triangles; }
+
+	// Bounding sphere of every meshlet
+	const glm::vec3& GetCenter() const { return m_Center; }
+	float GetRadius() const { return m_Radius; }
+
+	// Meshlets of a submesh with a triangle list of indices into vertices.
+	// indices is reordered in place
+	static List<Meshlet> Build(const List<Vertex>& vertices,
+							   List<uint32_t>& indices,
+							   uint32_t maxTriangles, uint32_t maxVertices);
+
+	// Adds the ranges of the meshlets that can be seen, transformed by tr,
+	// to out. Meshlets next to each other in the index list share a range
+	static MeshletCullStats Cull(const List<Meshlet>& meshlets,
+								 const glm::mat4& tr, const Frustum& frustum,
+								 const glm::vec3& camera,
+								 List<MeshletRange>& out);
+
+private:
+	List<List<Meshlet>> m_Meshlets;
+	uint64_t m_Count = 0;
+	uint64_t m_Triangles = 0;
+	glm::vec3 m_Center = glm::vec3(0.0f);
+	float m_Radius = 0.0f;
+};
+
+}
@@ -0,0 +1,66 @@
+#include "RangeAllocator.h"
+
+using namespace VolcaniCore;
+
+namespace Magma::Graphics {
+
+void RangeAllocator::Init(uint64_t capacity) {
+	m_Capacity = capacity;
+	m_Used = 0;
+	m_Free.Clear();
+	if(capacity)
+		m_Free.Add({ 0, capacity });
+}
+
+bool RangeAllocator::Allocate(uint64_t count, uint64_t& start) {
+	if(!count) {
+		start = 0;
+		return true;
+	}
+
+	for(uint64_t i = 0; i < m_Free.Count(); i++) {
+		auto& range = m_Free[i];
+		if(range.Count < count)
+			continue;
+
+		start = range.Start;
+		range.Start += count;
+		range.Count -= count;
+		if(!range.Count)
+			m_Free.Pop(i);
+
+		m_Used += count;
+		return true;
+	}
+
+	return false;
+}
+
+void RangeAllocator::Free(uint64_t start, uint64_t count) {
+	if(!count)
+		return;
+
+	m_Used -= count;
+
+	uint64_t i = 0;
+	while(i < m_Free.Count() && m_Free[i].Start < start)
+		i++;
+
+	// Merged with the neighbours it touches
+	bool before = i > 0 && m_Free[i - 1].Start + m_Free[i - 1].Count == start;
+	bool after = i < m_Free.Count() && start + count == m_Free[i].Start;
+	if(before && after) {
+		m_Free[i - 1].Count += count + m_Free[i].Count;
+		m_Free.Pop(i);
+	}
+	else if(before)
+		m_Free[i - 1].Count += count;
+	else if(after) {
+		m_Free[i].Start = start;
+		m_Free[i].Count += count;
+	}
+	else
+		m_Free.Insert(i, { start, count });
+}
+
+}
\ No newline at end of file
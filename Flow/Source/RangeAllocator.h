@@ -0,0 +1,36 @@
+#pragma once
+
+#include <VolcaniCore/Core/Defines.h>
+
+using namespace VolcaniCore;
+
+namespace Magma::Graphics {
+
+// Hands out ranges of a stream of capacity elements. First fit over a list
+// of free ranges kept in order, a freed range is merged with the free
+// ranges it touches.
+class RangeAllocator {
+public:
+	// Everything is free again
+	void Init(uint64_t capacity);
+	// False when no free range holds count
+	bool Allocate(uint64_t count, uint64_t& start);
+	void Free(uint64_t start, uint64_t count);
+
+	uint64_t GetCapacity() const { return m_Capacity; }
+	uint64_t GetUsed() const { return m_Used; }
+	// More than one with space free means it is fragmented
+	uint64_t GetFreeRangeCount() const { return m_Free.Count(); }
+
+private:
+	struct Range {
+		uint64_t Start;
+		uint64_t Count;
+	};
+
+	List<Range> m_Free;
+	uint64_t m_Capacity = 0;
+	uint64_t m_Used = 0;
+};
+
+}
\ No newline at end of file
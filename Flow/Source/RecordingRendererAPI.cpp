@@ -0,0 +1,221 @@
+#include "RecordingRendererAPI.h"
+
+#include <algorithm>
+
+#include <glm/common.hpp>
+
+#include <VolcaniCore/Core/Assert.h>
+
+using namespace VolcaniCore;
+
+namespace Magma::Graphics {
+
+RecordingRendererAPI::RecordingRendererAPI(bool keepData)
+	: m_KeepData(keepData) { }
+
+RecordingRendererAPI::~RecordingRendererAPI() {
+	for(auto* pass : m_Passes)
+		delete pass;
+	for(auto* buffer : m_Buffers)
+		delete buffer;
+}
+
+void RecordingRendererAPI::StartFrame() {
+	m_Last = std::move(m_Current);
+	m_Current = { };
+}
+
+void RecordingRendererAPI::EndFrame() {
+	// Slots start over, keeping what their calls grew into
+	for(uint64_t i = 0; i < m_CommandCount; i++) {
+		auto& command = m_Commands[i];
+		Record(command);
+
+		auto calls = std::move(command.Calls);
+		calls.Clear();
+		command = { };
+		command.Calls = std::move(calls);
+	}
+
+	m_CommandCount = 0;
+}
+
+DrawBuffer* RecordingRendererAPI::NewDrawBuffer(DrawBufferSpecification& specs,
+												void* data)
+{
+	auto* buffer = new DrawBuffer{ specs };
+	m_Buffers.Add(buffer);
+	m_BufferData.Add({ });
+
+	if(data)
+		SetBufferData(buffer, DrawBufferIndex::Vertices, data,
+					  specs.MaxVertexCount);
+
+	return buffer;
+}
+
+void RecordingRendererAPI::SetBufferData(DrawBuffer* buffer,
+										 DrawBufferIndex type,
+										 const void* data, uint64_t count,
+										 uint64_t start)
+{
+	VOLCANICORE_ASSERT(buffer);
+
+	uint64_t end = start + count;
+	if(type == DrawBufferIndex::Indices)
+		buffer->IndicesCount = glm::max<uint64_t>(buffer->IndicesCount, end);
+	else if(type == DrawBufferIndex::Vertices)
+		buffer->VerticesCount = glm::max<uint64_t>(buffer->VerticesCount, end);
+	else
+		buffer->InstancesCount =
+			glm::max<uint64_t>(buffer->InstancesCount, end);
+
+	RecordedUpload upload;
+	upload.Buffer = GetBufferID(buffer);
+	upload.Index = type;
+	upload.Offset = start;
+	upload.Count = count;
+	upload.Bytes = count * GetStride(buffer, type);
+	if(m_KeepData && data) {
+		auto* bytes = static_cast<const uint8_t*>(data);
+		upload.Data.assign(bytes, bytes + upload.Bytes);
+
+		auto& contents = m_BufferData[upload.Buffer - 1];
+		auto& dst = type == DrawBufferIndex::Indices  ? contents.Indices
+				  : type == DrawBufferIndex::Vertices ? contents.Vertices
+				  : contents.Instances;
+		uint64_t offset = start * GetStride(buffer, type);
+		if(dst.size() < offset + upload.Bytes)
+			dst.resize(offset + upload.Bytes);
+		std::copy(bytes, bytes + upload.Bytes, dst.begin() + offset);
+	}
+
+	m_Current.Stats.Uploads++;
+	m_Current.Stats.UploadBytes += upload.Bytes;
+	m_Total.Uploads++;
+	m_Total.UploadBytes += upload.Bytes;
+	m_Current.Uploads.Add(upload);
+}
+
+void RecordingRendererAPI::ReleaseBuffer(DrawBuffer* buffer) {
+	auto [found, i] =
+		m_Buffers.Find([=](DrawBuffer* b) -> bool { return b == buffer; });
+	if(!found)
+		return;
+
+	m_Buffers[i] = nullptr;
+	m_BufferData[i] = { };
+	delete buffer;
+}
+
+DrawPass* RecordingRendererAPI::NewDrawPass(DrawBuffer* buffer,
+											Ref<ShaderPipeline> pipeline,
+											Ref<Framebuffer> output)
+{
+	auto* pass = new DrawPass{ buffer, pipeline, output };
+	m_Passes.Add(pass);
+	return pass;
+}
+
+DrawCommand* RecordingRendererAPI::NewDrawCommand(DrawPass* pass) {
+	if(m_CommandCount == m_Commands.size())
+		m_Commands.emplace_back();
+
+	auto& command = m_Commands[m_CommandCount++];
+	command.Pass = pass;
+	return &command;
+}
+
+RendererAPI::DebugInfo RecordingRendererAPI::GetDebugInfo() {
+	RendererAPI::DebugInfo info{ };
+	info.DrawCallCount = m_Current.Stats.DrawCalls;
+	info.IndexCount	   = m_Current.Stats.Indices;
+	info.VertexCount   = m_Current.Stats.Vertices;
+	info.InstanceCount = m_Current.Stats.Instances;
+	return info;
+}
+
+uint32_t RecordingRendererAPI::GetBufferID(DrawBuffer* buffer) const {
+	auto [found, i] =
+		m_Buffers.Find([=](DrawBuffer* b) -> bool { return b == buffer; });
+	return found ? i + 1 : 0;
+}
+
+uint32_t RecordingRendererAPI::GetPassID(DrawPass* pass) const {
+	auto [found, i] =
+		m_Passes.Find([=](DrawPass* p) -> bool { return p == pass; });
+	return found ? i + 1 : 0;
+}
+
+template<typename TMap>
+static void RecordUniforms(const TMap& uniforms, RecordedUniformType type,
+						   List<RecordedUniform>& out, bool keepData)
+{
+	for(auto& [name, value] : uniforms) {
+		RecordedUniform uniform{ name, type, sizeof(value) };
+		if(keepData) {
+			auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+			uniform.Data.assign(bytes, bytes + sizeof(value));
+		}
+		out.Add(uniform);
+	}
+}
+
+void RecordingRendererAPI::Record(const DrawCommand& command) {
+	RecordedDrawCommand recorded;
+	recorded.Pass = GetPassID(command.Pass);
+	recorded.Clear = command.Clear;
+	recorded.DepthTest = command.DepthTest;
+	recorded.Blending = command.Blending;
+	recorded.Culling = command.Culling;
+	recorded.ViewportWidth = command.ViewportWidth;
+	recorded.ViewportHeight = command.ViewportHeight;
+	recorded.IndicesIndex = command.IndicesIndex;
+	recorded.VerticesIndex = command.VerticesIndex;
+	recorded.ComputeX = command.ComputeX;
+	recorded.Calls = command.Calls;
+
+	using Type = RecordedUniformType;
+	auto& data = command.UniformData;
+	auto& out = recorded.Uniforms;
+	RecordUniforms(data.IntUniforms,   Type::Int,   out, m_KeepData);
+	RecordUniforms(data.FloatUniforms, Type::Float, out, m_KeepData);
+	RecordUniforms(data.Vec2Uniforms,  Type::Vec2,  out, m_KeepData);
+	RecordUniforms(data.Vec3Uniforms,  Type::Vec3,  out, m_KeepData);
+	RecordUniforms(data.Vec4Uniforms,  Type::Vec4,  out, m_KeepData);
+	RecordUniforms(data.Mat4Uniforms,  Type::Mat4,  out, m_KeepData);
+
+	auto& stats = m_Current.Stats;
+	stats.Commands++;
+	m_Total.Commands++;
+	for(auto& uniform : recorded.Uniforms) {
+		stats.Uniforms++;
+		stats.UniformBytes += uniform.Bytes;
+		m_Total.Uniforms++;
+		m_Total.UniformBytes += uniform.Bytes;
+	}
+	for(auto& call : command.Calls) {
+		uint64_t instances =
+			call.Partition == PartitionType::Instanced ? call.InstanceCount : 0;
+		for(auto* s : { &stats, &m_Total }) {
+			s->DrawCalls++;
+			s->Indices += call.IndexCount;
+			s->Vertices += call.VertexCount;
+			s->Instances += instances;
+		}
+	}
+
+	m_Current.Commands.Add(recorded);
+}
+
+uint64_t RecordingRendererAPI::GetStride(DrawBuffer* buffer,
+										 DrawBufferIndex type) const
+{
+	if(type == DrawBufferIndex::Indices)
+		return sizeof(uint32_t);
+	if(type == DrawBufferIndex::Vertices)
+		return buffer->Specs.VertexLayout.Stride;
+	return buffer->Specs.InstanceLayout.Stride;
+}
+
+}
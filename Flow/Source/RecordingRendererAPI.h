@@ -0,0 +1,137 @@
+#pragma once
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <VolcaniCore/Core/Defines.h>
+
+#include "RendererAPI.h"
+
+using namespace VolcaniCore;
+
+namespace Magma::Graphics {
+
+struct RecordedUpload {
+	uint32_t Buffer;
+	DrawBufferIndex Index;
+	uint64_t Offset;
+	uint64_t Count;
+	uint64_t Bytes;
+	std::vector<uint8_t> Data;
+};
+
+enum class RecordedUniformType : uint8_t {
+	Int, Float, Vec2, Vec3, Vec4, Mat4
+};
+
+struct RecordedUniform {
+	std::string Name;
+	RecordedUniformType Type;
+	uint64_t Bytes;
+	std::vector<uint8_t> Data;
+};
+
+struct RecordedDrawCommand {
+	uint32_t Pass;
+	bool Clear;
+	DepthTestingMode DepthTest;
+	BlendingMode Blending;
+	CullingMode Culling;
+	uint32_t ViewportWidth;
+	uint32_t ViewportHeight;
+	uint64_t IndicesIndex;
+	uint64_t VerticesIndex;
+	uint32_t ComputeX;
+
+	List<RecordedUniform> Uniforms;
+	List<DrawCall> Calls;
+};
+
+struct RecordingStats {
+	uint64_t Commands	  = 0;
+	uint64_t DrawCalls	  = 0;
+	uint64_t Indices	  = 0;
+	uint64_t Vertices	  = 0;
+	uint64_t Instances	  = 0;
+	uint64_t Uniforms	  = 0;
+	uint64_t UniformBytes = 0;
+	uint64_t Uploads	  = 0;
+	uint64_t UploadBytes  = 0;
+};
+
+// The contents of a buffer as of the last upload, kept with data recording
+struct RecordedBufferData {
+	std::vector<uint8_t> Indices;
+	std::vector<uint8_t> Vertices;
+	std::vector<uint8_t> Instances;
+};
+
+struct RecordedFrame {
+	List<RecordedUpload> Uploads;
+	List<RecordedDrawCommand> Commands;
+	RecordingStats Stats;
+};
+
+// Backend that never touches a GPU. Everything the Renderer hands it is
+// kept as plain data, so frames can be inspected, compared or timed
+// without a driver in the way.
+class RecordingRendererAPI : public RendererAPI {
+public:
+	RecordingRendererAPI(bool keepData = true);
+	~RecordingRendererAPI();
+
+	void StartFrame() override;
+	void EndFrame() override;
+
+	DrawBuffer* NewDrawBuffer(DrawBufferSpecification& specs,
+							  void* data = nullptr) override;
+	void SetBufferData(DrawBuffer* buffer, DrawBufferIndex type,
+					   const void* data, uint64_t count,
+					   uint64_t start = 0) override;
+	void ReleaseBuffer(DrawBuffer* buffer) override;
+
+	DrawPass* NewDrawPass(DrawBuffer* buffer, Ref<ShaderPipeline> pipeline,
+						  Ref<Framebuffer> output = nullptr) override;
+	DrawCommand* NewDrawCommand(DrawPass* pass) override;
+
+	RendererAPI::DebugInfo GetDebugInfo() override;
+
+	// The frame being recorded, and the one before it
+	const RecordedFrame& GetCurrentFrame() const { return m_Current; }
+	const RecordedFrame& GetLastFrame() const { return m_Last; }
+	const RecordingStats& GetTotalStats() const { return m_Total; }
+
+	uint32_t GetBufferID(DrawBuffer* buffer) const;
+	uint32_t GetPassID(DrawPass* pass) const;
+
+	// IDs start at 1, a released buffer stays as nullptr
+	uint32_t GetBufferCount() const { return m_Buffers.Count(); }
+	uint32_t GetPassCount() const { return m_Passes.Count(); }
+	DrawBuffer* GetBuffer(uint32_t id) const { return m_Buffers[id - 1]; }
+	DrawPass* GetPass(uint32_t id) const { return m_Passes[id - 1]; }
+	const RecordedBufferData& GetBufferData(uint32_t id) const {
+		return m_BufferData[id - 1];
+	}
+
+private:
+	const bool m_KeepData;
+
+	List<DrawBuffer*> m_Buffers;
+	List<RecordedBufferData> m_BufferData;
+	List<DrawPass*> m_Passes;
+	// Slots outlive the frame and are handed out again, only the first
+	// m_CommandCount are in use
+	std::deque<DrawCommand> m_Commands;
+	uint64_t m_CommandCount = 0;
+
+	RecordedFrame m_Current;
+	RecordedFrame m_Last;
+	RecordingStats m_Total;
+
+private:
+	void Record(const DrawCommand& command);
+	uint64_t GetStride(DrawBuffer* buffer, DrawBufferIndex type) const;
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,278 @@
+#include "RenderGraph.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <VolcaniCore/Core/Assert.h>
+
+using namespace VolcaniCore;
+
+namespace Magma::Graphics {
+
+const uint32_t RenderGraph::ReleaseAfter = 120;
+
+RenderGraphResource RenderGraph::Import(const std::string& name,
+										Ref<Framebuffer> target)
+{
+	Resource resource;
+	resource.Name = name;
+	resource.Imported = true;
+	resource.Target = target;
+	m_Resources.Add(resource);
+	m_Compiled = false;
+	return m_Resources.Count() - 1;
+}
+
+RenderGraphResource RenderGraph::Create(const std::string& name,
+										const TransientDesc& desc)
+{
+	Resource resource;
+	resource.Name = name;
+	resource.Desc = desc;
+	resource.Imported = false;
+	m_Resources.Add(resource);
+	m_Compiled = false;
+	return m_Resources.Count() - 1;
+}
+
+void RenderGraph::MarkOutput(RenderGraphResource resource) {
+	VOLCANICORE_ASSERT(m_Resources[resource].Imported,
+					   "Only imported resources can be outputs");
+	m_Resources[resource].Output = true;
+	m_Compiled = false;
+}
+
+void RenderGraph::AddPass(const std::string& name,
+						  const List<RenderGraphResource>& reads,
+						  const List<RenderGraphResource>& writes,
+						  const Func<void>& execute)
+{
+	m_Passes.Add({ name, reads, writes, execute });
+	m_Compiled = false;
+}
+
+void RenderGraph::Compile() {
+	Cull();
+	Allocate();
+	m_Compiled = true;
+}
+
+void RenderGraph::Execute() {
+	if(!m_Compiled)
+		Compile();
+
+	for(auto& pass : m_Passes)
+		if(!pass.Culled && pass.Execute)
+			pass.Execute();
+}
+
+void RenderGraph::Clear() {
+	m_Resources.Clear();
+	m_Passes.Clear();
+	m_Compiled = false;
+}
+
+Ref<Framebuffer> RenderGraph::Get(RenderGraphResource resource) const {
+	auto& res = m_Resources[resource];
+	if(res.Imported)
+		return res.Target;
+	if(res.Physical < 0)
+		return nullptr;
+	return m_Pool[res.Physical].Target;
+}
+
+const List<Ref<Texture>>&
+RenderGraph::GetLevels(RenderGraphResource resource) const {
+	static const List<Ref<Texture>> s_None;
+
+	auto& res = m_Resources[resource];
+	if(res.Imported || res.Physical < 0)
+		return s_None;
+	return m_Pool[res.Physical].Levels;
+}
+
+Ref<RenderPass> RenderGraph::GetRenderPass(const std::string& name,
+										   Ref<ShaderPipeline> pipeline,
+										   RenderGraphResource output,
+										   DrawBuffer* data)
+{
+	auto target = Get(output);
+	auto& pass = m_RenderPasses[name];
+	if(!pass || pass->GetOutput() != target) {
+		pass = RenderPass::Create(name, pipeline, target);
+		pass->SetData(data);
+	}
+
+	return pass;
+}
+
+bool RenderGraph::IsCulled(const std::string& name) const {
+	for(auto& pass : m_Passes)
+		if(pass.Name == name)
+			return pass.Culled;
+	return true;
+}
+
+std::string RenderGraph::Print() const {
+	auto names =
+		[this](const List<RenderGraphResource>& list)
+		{
+			std::string str;
+			for(auto id : list)
+				str += (str.empty() ? "" : ", ") + m_Resources[id].Name;
+			return str;
+		};
+
+	std::string str;
+	uint32_t index = 0;
+	for(auto& pass : m_Passes) {
+		str += std::to_string(index++) + " " + pass.Name;
+		if(pass.Culled)
+			str += " (culled)";
+		str += ": " + names(pass.Reads) + " -> " + names(pass.Writes) + "\n";
+	}
+
+	return str;
+}
+
+void RenderGraph::Cull() {
+	List<bool> needed;
+	for(auto& res : m_Resources)
+		needed.Add(res.Output);
+
+	// Walking backwards, a pass lives if anything later needs what it writes.
+	// A pass that writes nothing has effects the graph can't see
+	for(int32_t i = (int32_t)m_Passes.Count() - 1; i >= 0; i--) {
+		auto& pass = m_Passes[i];
+
+		bool live = !pass.Writes;
+		for(auto id : pass.Writes)
+			live |= needed[id];
+
+		pass.Culled = !live;
+		if(live)
+			for(auto id : pass.Reads)
+				needed[id] = true;
+	}
+}
+
+void RenderGraph::Allocate() {
+	for(auto& res : m_Resources) {
+		res.Physical = -1;
+		res.FirstUse = -1;
+		res.LastUse = -1;
+	}
+
+	for(int32_t i = 0; i < (int32_t)m_Passes.Count(); i++) {
+		auto& pass = m_Passes[i];
+		if(pass.Culled)
+			continue;
+
+		auto use =
+			[&](RenderGraphResource id)
+			{
+				auto& res = m_Resources[id];
+				if(res.FirstUse < 0)
+					res.FirstUse = i;
+				res.LastUse = i;
+			};
+		for(auto id : pass.Reads)
+			use(id);
+		for(auto id : pass.Writes)
+			use(id);
+	}
+
+	std::vector<uint32_t> transients;
+	for(uint32_t i = 0; i < m_Resources.Count(); i++)
+		if(!m_Resources[i].Imported && m_Resources[i].FirstUse >= 0)
+			transients.push_back(i);
+
+	std::stable_sort(transients.begin(), transients.end(),
+		[this](uint32_t a, uint32_t b)
+		{
+			return m_Resources[a].FirstUse < m_Resources[b].FirstUse;
+		});
+
+	List<bool> used;
+	for(auto& target : m_Pool) {
+		target.FreeAfter = -1;
+		used.Add(false);
+	}
+
+	// A target is free again once the last pass touching its current
+	// resource has run
+	for(auto id : transients) {
+		auto& res = m_Resources[id];
+
+		int32_t physical = -1;
+		for(uint32_t i = 0; i < m_Pool.Count(); i++) {
+			auto& target = m_Pool[i];
+			if(target.Desc == res.Desc && target.FreeAfter < res.FirstUse) {
+				physical = i;
+				break;
+			}
+		}
+
+		if(physical < 0) {
+			physical = m_Pool.Count();
+			m_Pool.Add(CreateTarget(res.Desc));
+			used.Add(false);
+		}
+
+		res.Physical = physical;
+		m_Pool[physical].FreeAfter = res.LastUse;
+		used[physical] = true;
+	}
+
+	// Release what has gone unused for a while, from the back so the
+	// indices just handed out stay valid
+	for(int32_t i = (int32_t)m_Pool.Count() - 1; i >= 0; i--) {
+		auto& target = m_Pool[i];
+		target.Unused = used[i] ? 0 : target.Unused + 1;
+		if(target.Unused <= ReleaseAfter)
+			continue;
+
+		for(auto& [_, pass] : m_RenderPasses)
+			if(pass && pass->GetOutput() == target.Target)
+				pass = nullptr;
+
+		m_Pool.Pop(i);
+		for(auto& res : m_Resources)
+			if(res.Physical > i)
+				res.Physical--;
+	}
+}
+
+RenderGraph::PooledTarget RenderGraph::CreateTarget(const TransientDesc& desc)
+{
+	PooledTarget target;
+	target.Desc = desc;
+
+	if(m_TargetFactory) {
+		target.Target = m_TargetFactory(desc, target.Levels);
+		return target;
+	}
+
+	if(!desc.Levels) {
+		target.Target = Framebuffer::Create(desc.Width, desc.Height);
+		return target;
+	}
+
+	uint32_t width = desc.Width;
+	uint32_t height = desc.Height;
+	for(uint32_t i = 0; i < desc.Levels; i++) {
+		width = std::max(width / 2, 1u);
+		height = std::max(height / 2, 1u);
+		target.Levels
+		.Add(Texture::Create(width, height, Texture::Format::Float));
+	}
+
+	target.Target = Framebuffer::Create(
+		{
+			{ AttachmentTarget::Color, target.Levels }
+		});
+
+	return target;
+}
+
+}
\ No newline at end of file
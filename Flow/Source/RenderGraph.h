@@ -0,0 +1,136 @@
+#pragma once
+
+#include <string>
+
+#include <VolcaniCore/Core/Defines.h>
+
+#include "Graphics/RendererAPI.h"
+#include "Graphics/RenderPass.h"
+#include "Graphics/Framebuffer.h"
+#include "Graphics/Texture.h"
+
+using namespace VolcaniCore;
+
+namespace Magma::Graphics {
+
+using RenderGraphResource = uint32_t;
+
+// An attachment owned by the graph. With Levels set the target is a chain
+// of that many color attachments, the first half of Width x Height and each
+// one after half of the one before
+struct TransientDesc {
+	uint32_t Width = 0;
+	uint32_t Height = 0;
+	uint32_t Levels = 0;
+
+	bool operator ==(const TransientDesc& other) const {
+		return Width == other.Width && Height == other.Height
+			&& Levels == other.Levels;
+	}
+};
+
+// Makes the target backing transients with the description. Targets with
+// levels have them added to the list, in the order they are attached
+using RenderGraphTargetFactory =
+	Func<Ref<Framebuffer>, const TransientDesc&, List<Ref<Texture>>&>;
+
+// Passes declare what they read and write and run in the order they were
+// added. Passes whose writes never reach an output are culled, and
+// transient targets with the same description share memory when their
+// lifetimes don't overlap. The graph is meant to be rebuilt every frame,
+// the targets backing it are kept in a pool across frames.
+class RenderGraph {
+public:
+	RenderGraph() = default;
+	~RenderGraph() = default;
+
+	RenderGraph(const RenderGraph&) = delete;
+	RenderGraph& operator =(const RenderGraph&) = delete;
+
+	// Targets come from Framebuffer and Texture unless set otherwise. Only
+	// affects targets the pool doesn't have yet
+	void SetTargetFactory(const RenderGraphTargetFactory& factory) {
+		m_TargetFactory = factory;
+	}
+
+	RenderGraphResource Import(const std::string& name,
+							   Ref<Framebuffer> target);
+	RenderGraphResource Create(const std::string& name,
+							   const TransientDesc& desc);
+
+	// Imported resources that are read after the graph has run
+	void MarkOutput(RenderGraphResource resource);
+
+	void AddPass(const std::string& name,
+				 const List<RenderGraphResource>& reads,
+				 const List<RenderGraphResource>& writes,
+				 const Func<void>& execute);
+
+	// Culls passes, then assigns pooled targets to the transients
+	void Compile();
+	void Execute();
+	// Forgets passes and resources, the pool stays
+	void Clear();
+
+	Ref<Framebuffer> Get(RenderGraphResource resource) const;
+	const List<Ref<Texture>>& GetLevels(RenderGraphResource resource) const;
+
+	// A render pass drawing into the target backing the resource, created
+	// again only when that target changes
+	Ref<RenderPass> GetRenderPass(const std::string& name,
+								  Ref<ShaderPipeline> pipeline,
+								  RenderGraphResource output,
+								  DrawBuffer* data);
+
+	bool IsCulled(const std::string& pass) const;
+	uint32_t GetTargetCount() const { return m_Pool.Count(); }
+
+	// One line per pass in execution order
+	std::string Print() const;
+
+	// Frames a pooled target may go unused before it is released
+	static const uint32_t ReleaseAfter;
+
+private:
+	struct Resource {
+		std::string Name;
+		TransientDesc Desc;
+		bool Imported;
+		bool Output = false;
+
+		Ref<Framebuffer> Target;
+		int32_t Physical = -1;
+		int32_t FirstUse = -1;
+		int32_t LastUse = -1;
+	};
+
+	struct Pass {
+		std::string Name;
+		List<RenderGraphResource> Reads;
+		List<RenderGraphResource> Writes;
+		Func<void> Execute;
+		bool Culled = false;
+	};
+
+	struct PooledTarget {
+		TransientDesc Desc;
+		Ref<Framebuffer> Target;
+		List<Ref<Texture>> Levels;
+		int32_t FreeAfter = -1;
+		uint32_t Unused = 0;
+	};
+
+	List<Resource> m_Resources;
+	List<Pass> m_Passes;
+	List<PooledTarget> m_Pool;
+	Map<std::string, Ref<RenderPass>> m_RenderPasses;
+	RenderGraphTargetFactory m_TargetFactory;
+	bool m_Compiled = false;
+
+private:
+	void Cull();
+	void Allocate();
+	PooledTarget CreateTarget(const TransientDesc& desc);
+};
+
+}
\ No newline at end of file
@@ -1,13 +1,20 @@
 #include "Renderer.h"
 
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <unordered_map>
+
 #include <VolcaniCore/Core/Application.h>
 #include <VolcaniCore/Core/Assert.h>
 #include <VolcaniCore/Core/Defines.h>
+#include <VolcaniCore/Core/Log.h>
 
 #include "RendererAPI.h"
 #include "RenderPass.h"
 #include "Renderer2D.h"
 #include "Renderer3D.h"
+#include "SortKey.h"
 
 using namespace VolcaniCore;
 
@@ -15,16 +22,105 @@ using namespace VolcaniCore;
 
 namespace Magma::Graphics {
 
-const uint64_t Renderer::MaxTriangles = 1'000'000;
-const uint64_t Renderer::MaxIndices   = MaxTriangles * 6;
-const uint64_t Renderer::MaxVertices  = MaxTriangles * 3;
-const uint64_t Renderer::MaxInstances = MaxTriangles * 4;
-
+static Ref<RendererAPI> s_API;
 static FrameData s_Frame;
 static Ref<RenderPass> s_RenderPass;
 static List<DrawCommand*> s_Stack;
 
-static bool s_OptionsValid = false;
+static CommandList s_CommandList;
+static uint64_t s_BindingsUnsorted = 0;
+static uint64_t s_BindingsSorted = 0;
+
+static List<RenderOptions> s_Options = { RenderOptions::Default() };
+static RenderOptions s_AppliedOptions;
+static bool s_HasAppliedOptions = false;
+static uint64_t s_StateChanges = 0;
+static uint64_t s_RedundantStates = 0;
+
+using Clock = std::chrono::steady_clock;
+
+static Clock::time_point s_FrameStart;
+
+// Passes are known through their owner, an entry whose owner is gone is
+// stale, its address may already belong to another pass
+struct KnownPass {
+	std::weak_ptr<RenderPass> Owner;
+	std::string Name;
+};
+
+static Map<DrawPass*, KnownPass> s_KnownPasses;
+static Map<DrawBuffer*, DrawBuffer*> s_ReboundBuffers;
+static Map<std::string, uint32_t> s_PassIndices;
+static List<PassDebugInfo> s_Passes;
+static List<uint32_t> s_Scopes;
+
+static float s_FrameLimit = 0.0f;
+static Clock::time_point s_NextFrame;
+
+static List<FrameDebugInfo> s_History;
+static uint32_t s_HistorySize = 120;
+static uint32_t s_HistoryNext = 0;
+
+static float ElapsedMs(Clock::time_point start) {
+	std::chrono::duration<float, std::milli> elapsed = Clock::now() - start;
+	return elapsed.count();
+}
+
+static uint32_t GetPassInfo(const std::string& name) {
+	if(s_PassIndices.count(name))
+		return s_PassIndices[name];
+
+	uint32_t index = s_Passes.Count();
+	s_Passes.Add({ name, (uint32_t)s_Scopes.Count() });
+	s_PassIndices[name] = index;
+	return index;
+}
+
+static const KnownPass* FindPass(DrawPass* pass) {
+	auto it = s_KnownPasses.find(pass);
+	if(it == s_KnownPasses.end() || it->second.Owner.expired())
+		return nullptr;
+	return &it->second;
+}
+
+// Names are kept from the first time a pass is seen. Passes first seen
+// after their buffer was replaced catch up here
+static void TrackPass(const Ref<RenderPass>& pass) {
+	DrawPass* drawPass = pass->Get();
+	auto it = s_KnownPasses.find(drawPass);
+	if(it != s_KnownPasses.end() && it->second.Owner.lock() == pass)
+		return;
+
+	s_KnownPasses[drawPass] = { pass, pass->GetName() };
+	while(s_ReboundBuffers.count(drawPass->BufferData))
+		drawPass->BufferData = s_ReboundBuffers[drawPass->BufferData];
+}
+
+static uint32_t GetPassInfo(DrawPass* pass) {
+	if(auto* known = FindPass(pass))
+		return GetPassInfo(known->Name);
+	return GetPassInfo(pass ? "Unnamed" : "None");
+}
+
+// Scopes come before the passes they contain, one level less deep
+static void AddScopeTimes() {
+	for(uint64_t i = s_Passes.Count(); i-- > 0; ) {
+		auto& pass = s_Passes[i];
+		if(!pass.Depth)
+			continue;
+
+		for(uint64_t j = i; j-- > 0; ) {
+			auto& scope = s_Passes[j];
+			if(scope.Depth != pass.Depth - 1)
+				continue;
+
+			scope.CPUTime += pass.CPUTime;
+			if(pass.GPUTime >= 0.0f)
+				scope.GPUTime = glm::max(scope.GPUTime, 0.0f) + pass.GPUTime;
+			break;
+		}
+	}
+}
 
 void Renderer::Init() {
 	s_Frame = { };
@@ -38,24 +134,128 @@ void Renderer::Close() {
 	Renderer2D::Close();
 }
 
+void Renderer::SetAPI(Ref<RendererAPI> api) {
+	s_API = api;
+}
+
+RendererAPI* Renderer::GetAPI() {
+	if(s_API)
+		return s_API.get();
+	return RendererAPI::Get();
+}
+
 void Renderer::BeginFrame() {
+	// The application only starts frames on its own backend
+	if(s_API)
+		s_API->StartFrame();
+
+	if(s_FrameStart != Clock::time_point{ }) {
+		float period = ElapsedMs(s_FrameStart);
+		s_Frame.Info.FramePeriod = period;
+		if(s_History)
+			s_History[(s_HistoryNext + s_History.Count() - 1)
+					  % s_History.Count()].FramePeriod = period;
+	}
+
+	s_FrameStart = Clock::now();
+	s_HasAppliedOptions = false;
+
 	Renderer2D::StartFrame();
 	Renderer3D::StartFrame();
 }
 
 void Renderer::EndFrame() {
-	auto info = RendererAPI::Get()->GetDebugInfo();
+	auto info = Renderer::GetAPI()->GetDebugInfo();
 	s_Frame.Info.DrawCalls = info.DrawCallCount;
 	s_Frame.Info.Indices   = info.IndexCount;
 	s_Frame.Info.Vertices  = info.VertexCount;
 	s_Frame.Info.Instances = info.InstanceCount;
 
+	auto& geometry = Renderer3D::GetGeometryCache();
+	s_Frame.Info.ResidentMeshes = geometry.GetResidentCount();
+	s_Frame.Info.GeometryUploaded = geometry.GetUploaded();
+
 	Renderer3D::EndFrame();
 	Renderer2D::EndFrame();
+
+	auto& arena = s_CommandList.GetArena();
+	s_Frame.Info.BindingsUnsorted = s_BindingsUnsorted;
+	s_Frame.Info.BindingsSorted = s_BindingsSorted;
+	s_BindingsUnsorted = 0;
+	s_BindingsSorted = 0;
+	s_Frame.Info.StateChanges = s_StateChanges;
+	s_Frame.Info.RedundantStates = s_RedundantStates;
+	s_StateChanges = 0;
+	s_RedundantStates = 0;
+
+	if(s_Options.Count() > 1) {
+		VOLCANICORE_LOG_WARNING("%u PushOptions without a PopOptions",
+								(uint32_t)s_Options.Count() - 1);
+		PopOptions(s_Options.Count() - 1);
+	}
+	s_Frame.Info.ArenaUsed = arena.GetUsed();
+	s_Frame.Info.ArenaPeak = arena.GetHighWaterMark();
+	s_Frame.Info.CommandsCreated = s_CommandList.GetCommandsCreated();
+	s_Frame.Info.CommandsReused = s_CommandList.GetCommandsReused();
+	s_Frame.Info.LODTriangles = s_CommandList.GetLODTriangles();
+	auto& meshlets = s_CommandList.GetMeshletStats();
+	s_Frame.Info.Meshlets = meshlets.Meshlets;
+	s_Frame.Info.MeshletsCulled = meshlets.Culled;
+	s_Frame.Info.MeshletTriangles = meshlets.Triangles;
+	s_Frame.Info.MeshletTrianglesCulled = meshlets.CulledTriangles;
+	s_CommandList.PublishLODs();
+	s_CommandList.Reset();
+
+	AddScopeTimes();
+	s_Frame.Info.FrameTime = ElapsedMs(s_FrameStart);
+	s_Frame.Info.GPUTime = -1.0f;
+	for(auto& pass : s_Passes)
+		if(!pass.Depth && pass.GPUTime >= 0.0f)
+			s_Frame.Info.GPUTime =
+				glm::max(s_Frame.Info.GPUTime, 0.0f) + pass.GPUTime;
+	s_Frame.Info.Passes = s_Passes;
+	s_Frame.Info.Buffers.Clear();
+	for(auto* buffer : GrowableBuffer::GetBuffers())
+		s_Frame.Info.Buffers.Add(buffer->GetDebugInfo());
+	s_Passes.Clear();
+	s_PassIndices.clear();
+	s_Scopes.Clear();
+
+	if(s_History.Count() < s_HistorySize)
+		s_History.Add(s_Frame.Info);
+	else
+		s_History[s_HistoryNext] = s_Frame.Info;
+	s_HistoryNext = (s_HistoryNext + 1) % s_HistorySize;
+
+	s_Frame.Info.FlushTime = 0.0f;
+
+	if(s_FrameLimit <= 0.0f)
+		return;
+
+	// Sleeps overshoot, so the last millisecond is spent spinning
+	auto sleep = s_NextFrame - Clock::now() - std::chrono::milliseconds(1);
+	if(sleep.count() > 0)
+		std::this_thread::sleep_for(sleep);
+	while(Clock::now() < s_NextFrame)
+		std::this_thread::yield();
+
+	// A frame that ran long starts the schedule over instead of letting
+	// the next ones catch up
+	auto period =
+		std::chrono::duration_cast<Clock::duration>(
+			std::chrono::duration<float, std::milli>(1000.0f / s_FrameLimit));
+	s_NextFrame += period;
+	if(s_NextFrame < Clock::now())
+		s_NextFrame = Clock::now() + period;
 }
 
 void Renderer::StartPass(Ref<RenderPass> pass, bool pushCommand) {
+	// Entered now so the pass is listed under the scopes open here
+	TrackPass(pass);
+	GetPassInfo(pass->GetName());
+
 	s_RenderPass = pass;
+	s_CommandList.SetPass(pass->Get());
 	if(pushCommand)
 		PushCommand();
 }
@@ -63,6 +263,7 @@ void Renderer::StartPass(Ref<RenderPass> pass, bool pushCommand) {
 void Renderer::EndPass() {
 	s_Stack.Clear();
 	s_RenderPass = nullptr;
+	s_CommandList.SetPass(nullptr);
 }
 
 Ref<RenderPass> Renderer::GetPass() {
@@ -90,12 +291,69 @@ DrawCommand* Renderer::NewCommand(bool usePrevious) {
 	if(usePrevious && s_Stack && !s_Stack[-1]->Calls)
 		return s_Stack[-1];
 
-	return RendererAPI::Get()->NewDrawCommand(s_RenderPass->Get());
+	return NewCommand(s_RenderPass->Get());
+}
+
+DrawCommand* Renderer::NewCommand(DrawPass* pass) {
+	return s_CommandList.NewCommand(pass);
+}
+
+DrawCommand* Renderer::NewCommand(Ref<RenderPass> pass) {
+	TrackPass(pass);
+	return NewCommand(pass->Get());
+}
+
+DrawCommand* Renderer::NewMaterial(Ref<RenderPass> pass) {
+	TrackPass(pass);
+	return s_CommandList.NewMaterial(pass->Get());
+}
+
+void Renderer::RebindBuffer(DrawBuffer* from, DrawBuffer* to) {
+	for(auto it = s_KnownPasses.begin(); it != s_KnownPasses.end(); ) {
+		if(it->second.Owner.expired()) {
+			it = s_KnownPasses.erase(it);
+			continue;
+		}
+
+		if(it->first->BufferData == from)
+			it->first->BufferData = to;
+		it++;
+	}
+
+	// The new buffer may reuse the address of one released earlier
+	s_ReboundBuffers.erase(to);
+	s_ReboundBuffers[from] = to;
+}
+
+std::string Renderer::GetPassName(DrawPass* pass) {
+	if(auto* known = FindPass(pass))
+		return known->Name;
+	return "";
+}
+
+void Renderer::SetSortMaterial(DrawCommand* command, uint64_t material) {
+	CommandList::SetSortMaterial(command, material);
+}
+
+void Renderer::SetSortDepth(DrawCommand* command, float depth) {
+	CommandList::SetSortDepth(command, depth);
+}
+
+CommandList& Renderer::GetCommandList() {
+	return s_CommandList;
+}
+
+void Renderer::Submit(CommandList& list) {
+	s_CommandList.Append(list);
+}
+
+FrameArena& Renderer::GetFrameArena() {
+	return s_CommandList.GetArena();
 }
 
 void Renderer::Clear() {
 	if(!s_Stack) {
-		RendererAPI::Get()->NewDrawCommand(nullptr)->Clear = true;
+		NewCommand(nullptr)->Clear = true;
 		Renderer::Flush();
 	}
 	else
@@ -107,23 +365,248 @@ void Renderer::Resize(uint32_t width, uint32_t height) {
 	GetCommand()->ViewportHeight = height;
 }
 
+void Renderer::PushOptions(const RenderOptions& options) {
+	s_Options.Add(options);
+	s_CommandList.SetOptions(options);
+}
+
 void Renderer::PushOptions() {
-	s_OptionsValid = true;
+	PushOptions(GetOptions());
 }
 
 void Renderer::PopOptions(uint32_t count) {
-	s_OptionsValid = false;
+	// The defaults at the bottom stay
+	for(; count && s_Options.Count() > 1; count--)
+		s_Options.Pop();
+	s_CommandList.SetOptions(s_Options[-1]);
+}
+
+const RenderOptions& Renderer::GetOptions() {
+	return s_Options[-1];
+}
+
+static void RadixSort(uint64_t* keys, uint32_t* order, uint64_t count) {
+	auto& arena = s_CommandList.GetArena();
+	uint64_t* srcKeys = keys;
+	uint32_t* srcOrder = order;
+	uint64_t* dstKeys = arena.NewArray<uint64_t>(count);
+	uint32_t* dstOrder = arena.NewArray<uint32_t>(count);
+
+	for(uint32_t shift = 0; shift < 64; shift += 8) {
+		uint64_t histogram[256] = { };
+		for(uint64_t i = 0; i < count; i++)
+			histogram[(srcKeys[i] >> shift) & 0xFF]++;
+
+		// Every key has the same byte here, nothing would move
+		if(histogram[(srcKeys[0] >> shift) & 0xFF] == count)
+			continue;
+
+		uint64_t offset = 0;
+		for(auto& bucket : histogram) {
+			uint64_t size = bucket;
+			bucket = offset;
+			offset += size;
+		}
+
+		for(uint64_t i = 0; i < count; i++) {
+			uint64_t dst = histogram[(srcKeys[i] >> shift) & 0xFF]++;
+			dstKeys[dst] = srcKeys[i];
+			dstOrder[dst] = srcOrder[i];
+		}
+
+		std::swap(srcKeys, dstKeys);
+		std::swap(srcOrder, dstOrder);
+	}
+
+	if(srcOrder != order) {
+		std::copy(srcKeys, srcKeys + count, keys);
+		std::copy(srcOrder, srcOrder + count, order);
+	}
+}
+
+// What a command binds before it draws, the pass bringing the shader
+struct PipelineState {
+	DrawPass* Pass;
+	RenderOptions Options;
+
+	PipelineState(const RecordedCommand* command)
+		: Pass(command->Pass),
+		Options{ command->DepthTest, command->Blending, command->Culling } { }
+
+	bool operator ==(const PipelineState& other) const {
+		return Pass == other.Pass && Options == other.Options;
+	}
+};
+
+struct PipelineStateHash {
+	size_t operator ()(const PipelineState& state) const {
+		size_t hash = std::hash<void*>()(state.Pass);
+		uint32_t options = (uint32_t)state.Options.DepthTest
+						 | (uint32_t)state.Options.Blending << 8
+						 | (uint32_t)state.Options.Culling << 16;
+		hash ^= std::hash<uint32_t>()(options) + 0x9e3779b9 + (hash << 6);
+		return hash;
+	}
+};
+
+// Handed out again every flush, so they stay small enough for the key
+static std::unordered_map<PipelineState, uint32_t, PipelineStateHash>
+	s_PipelineIDs;
+static Map<uint64_t, uint32_t> s_MaterialIDs;
+
+static uint32_t GetPipelineID(const RecordedCommand* command) {
+	auto [it, added] =
+		s_PipelineIDs.try_emplace(command, (uint32_t)s_PipelineIDs.size());
+	return it->second;
+}
+
+static uint32_t GetMaterialID(uint64_t material) {
+	auto [it, added] =
+		s_MaterialIDs.try_emplace(material, (uint32_t)s_MaterialIDs.size());
+	return it->second;
+}
+
+static uint64_t CountBindings(const uint32_t* order, uint64_t count) {
+	auto& commands = s_CommandList.GetCommands();
+	uint64_t changes = 0;
+	for(uint64_t i = 1; i < count; i++) {
+		auto* prev = commands[order[i - 1]];
+		auto* curr = commands[order[i]];
+		changes += !(PipelineState(prev) == PipelineState(curr))
+				|| prev->Material != curr->Material;
+	}
+	return changes;
 }
 
 void Renderer::Flush() {
+	auto flushStart = Clock::now();
+	s_CommandList.Upload();
+	Renderer3D::FlushInstances();
+
+	auto& commands = s_CommandList.GetCommands();
+	auto& arena = s_CommandList.GetArena();
+	uint64_t count = commands.Count();
+	auto* keys = arena.NewArray<uint64_t>(count);
+	auto* order = arena.NewArray<uint32_t>(count);
+	s_PipelineIDs.clear();
+	s_MaterialIDs.clear();
+
+	// Commands that clear or only carry uniforms and state are barriers,
+	// as are pass switches. Sorting only happens between two barriers
+	uint32_t group = 0;
+	bool wasBarrier = false;
+	for(uint64_t i = 0; i < count; i++) {
+		auto* command = commands[i];
+		bool barrier = command->Clear || !command->Calls;
+
+		bool passChanged = i && command->Pass != commands[i - 1]->Pass;
+		if(i && (barrier || wasBarrier || passChanged))
+			group++;
+		wasBarrier = barrier;
+
+		bool translucent = command->Blending != BlendingMode::Off;
+		keys[i] =
+			SortKey::Pack(group, translucent, GetPipelineID(command),
+						  GetMaterialID(command->Material), command->Depth);
+		order[i] = (uint32_t)i;
+	}
+
+	if(count > 1) {
+		s_BindingsUnsorted += CountBindings(order, count);
+		RadixSort(keys, order, count);
+		s_BindingsSorted += CountBindings(order, count);
+	}
+
+	// Each run of commands from one pass is timed as a whole
+	DrawPass* runPass = nullptr;
+	uint32_t runInfo = 0;
+	auto runStart = Clock::now();
+	for(uint64_t i = 0; i < count; i++) {
+		auto* command = commands[order[i]];
+		if(!i || command->Pass != runPass) {
+			if(i)
+				s_Passes[runInfo].CPUTime += ElapsedMs(runStart);
+			runPass = command->Pass;
+			runInfo = GetPassInfo(runPass);
+			runStart = Clock::now();
+		}
+
+		// Repeats of the state before are only counted. The backend has no
+		// state cache and applies all three for every command either way,
+		// the sort only places them next to each other
+		RenderOptions options =
+			{ command->DepthTest, command->Blending, command->Culling };
+		if(s_HasAppliedOptions && options == s_AppliedOptions)
+			s_RedundantStates++;
+		else
+			s_StateChanges++;
+		s_AppliedOptions = options;
+		s_HasAppliedOptions = true;
+
+		auto& info = s_Passes[runInfo];
+		info.Commands++;
+		for(auto& call : command->Calls) {
+			info.DrawCalls++;
+			info.Indices += call.IndexCount;
+			info.Vertices += call.VertexCount;
+			info.Instances += call.InstanceCount;
+		}
+
+		// Backends hand out slots they keep between frames. The command
+		// takes the slot's emptied calls in exchange, to grow into again
+		// next frame instead of allocating
+		std::swap(*Renderer::GetAPI()->NewDrawCommand(command->Pass),
+				  *static_cast<DrawCommand*>(command));
+	}
+	if(count)
+		s_Passes[runInfo].CPUTime += ElapsedMs(runStart);
+
+	s_CommandList.ClearCommands();
 	s_Stack.Clear();
-	RendererAPI::Get()->EndFrame();
+	Renderer::GetAPI()->EndFrame();
+
+	s_Frame.Info.FlushTime += ElapsedMs(flushStart);
+}
+
+void Renderer::PushScope(const std::string& name) {
+	s_Scopes.Add(GetPassInfo(name));
+}
+
+void Renderer::PopScope() {
+	if(s_Scopes)
+		s_Scopes.Pop();
 }
 
 FrameDebugInfo Renderer::GetDebugInfo() {
 	return s_Frame.Info;
 }
 
+List<FrameDebugInfo> Renderer::GetFrameHistory() {
+	List<FrameDebugInfo> history;
+	uint32_t start = s_History.Count() < s_HistorySize ? 0 : s_HistoryNext;
+	for(uint32_t i = 0; i < s_History.Count(); i++)
+		history.Add(s_History[(start + i) % s_History.Count()]);
+	return history;
+}
+
+void Renderer::SetFrameHistorySize(uint32_t size) {
+	s_History = GetFrameHistory();
+	while(s_History.Count() > size)
+		s_History.Pop(0);
+
+	s_HistorySize = glm::max(size, 1u);
+	s_HistoryNext = s_History.Count() % s_HistorySize;
+}
+
+void Renderer::SetFrameLimit(float fps) {
+	s_FrameLimit = glm::max(fps, 0.0f);
+	s_NextFrame = Clock::now();
+}
+
+float Renderer::GetFrameLimit() {
+	return s_FrameLimit;
+}
+
 FrameData& Renderer::GetFrame() {
 	return s_Frame;
 }
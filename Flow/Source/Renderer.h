@@ -1,20 +1,81 @@
 #pragma once
 
+#include <string>
+
 #include <VolcaniCore/Core/Defines.h>
 
 #include "RenderPass.h"
+#include "FrameArena.h"
+#include "CommandList.h"
+#include "GrowableBuffer.h"
 
 using namespace VolcaniCore;
 
 namespace Magma::Graphics {
 
+struct PassDebugInfo {
+	std::string Name;
+	uint32_t Depth = 0; // Nesting level, scopes contain the passes below them
+
+	// Milliseconds Flush spent handing the commands to the backend. A
+	// scope's times include the passes below it
+	float CPUTime = 0.0f;
+	float GPUTime = -1.0f; // Milliseconds, negative without timer queries
+
+	uint64_t Commands  = 0;
+	uint64_t DrawCalls = 0;
+	uint64_t Indices   = 0;
+	uint64_t Vertices  = 0;
+	uint64_t Instances = 0;
+};
+
 struct FrameDebugInfo {
 	float FPS;
+	float FrameTime = 0.0f; // Milliseconds from BeginFrame to EndFrame
+	float FlushTime = 0.0f; // Milliseconds spent in Flush
+	// Milliseconds from BeginFrame to the next BeginFrame, waiting for the
+	// frame limiter and the display included. Set when the next one starts
+	float FramePeriod = 0.0f;
+	float GPUTime = -1.0f; // Milliseconds, negative without timer queries
 
 	uint64_t DrawCalls = 0;
 	uint64_t Indices   = 0;
 	uint64_t Vertices  = 0;
 	uint64_t Instances = 0;
+
+	// Commands binding another pipeline or material than the command
+	// before them, in recorded order and in the order Flush sorted them
+	// into. Sorting translucent commands back to front can make the second
+	// larger
+	uint64_t BindingsUnsorted = 0;
+	uint64_t BindingsSorted = 0;
+	// Depth, blending and culling as handed to the backend, counted per
+	// command against the state of the command before it. Redundant ones
+	// are still applied, no backend skips them yet
+	uint64_t StateChanges = 0;
+	uint64_t RedundantStates = 0;
+
+	uint64_t ResidentMeshes = 0;
+	uint64_t GeometryUploaded = 0; // Bytes
+
+	uint64_t ArenaUsed = 0;
+	uint64_t ArenaPeak = 0;
+	// Commands the lists had to make, and ones kept from earlier frames
+	// along with the storage of their calls
+	uint64_t CommandsCreated = 0;
+	uint64_t CommandsReused = 0;
+
+	// Triangles drawn at each level of detail, full meshes being level 0
+	List<uint64_t> LODTriangles;
+	// Meshlets tested, and the ones left out for being off screen or
+	// facing away
+	uint64_t Meshlets = 0;
+	uint64_t MeshletsCulled = 0;
+	uint64_t MeshletTriangles = 0;
+	uint64_t MeshletTrianglesCulled = 0;
+
+	List<PassDebugInfo> Passes;
+	List<BufferDebugInfo> Buffers;
 };
 
 struct FrameData {
@@ -22,16 +83,17 @@ struct FrameData {
 };
 
 class Renderer {
-public:
-	static const uint64_t MaxTriangles;
-	static const uint64_t MaxIndices;
-	static const uint64_t MaxVertices;
-	static const uint64_t MaxInstances;
-
 public:
 	static void Init();
 	static void Close();
 
+	// The backend everything in Magma draws through. Set before Init to
+	// run on another one than the application's, like a
+	// RecordingRendererAPI for headless runs. Null goes back to the
+	// application's
+	static void SetAPI(Ref<RendererAPI> api);
+	static RendererAPI* GetAPI();
+
 	static void BeginFrame();
 	static void EndFrame();
 
@@ -45,16 +107,54 @@ public:
 	static void PopCommand();
 	static DrawCommand* GetCommand();
 	static DrawCommand* NewCommand(bool usePrevious = false);
+	static DrawCommand* NewCommand(DrawPass* pass);
+	static DrawCommand* NewCommand(Ref<RenderPass> pass);
+	// Uniforms for Renderer3D::DrawMesh to copy, see CommandList
+	static DrawCommand* NewMaterial(Ref<RenderPass> pass);
+	// Empty for passes never started or used through a RenderPass
+	static std::string GetPassName(DrawPass* pass);
+
+	// Moves every pass the Renderer has seen through a RenderPass that is
+	// still alive off a buffer that was replaced
+	static void RebindBuffer(DrawBuffer* from, DrawBuffer* to);
+
+	static void SetSortMaterial(DrawCommand* command, uint64_t material);
+	static void SetSortDepth(DrawCommand* command, float depth);
+
+	static CommandList& GetCommandList();
+	static FrameArena& GetFrameArena();
+
+	// Merges a list recorded on another thread. Lists are merged in the
+	// order they are submitted, wherever they were recorded
+	static void Submit(CommandList& list);
 
 	static void Clear();
 	static void Resize(uint32_t width, uint32_t height);
 
+	// Commands created until the matching PopOptions start with these
+	// options. Without arguments the current options are pushed again.
+	// Below everything pushed are RenderOptions::Default()
+	static void PushOptions(const RenderOptions& options);
 	static void PushOptions();
 	static void PopOptions(uint32_t count = 1);
+	static const RenderOptions& GetOptions();
 
 	static void Flush();
 
+	// Groups the passes started until PopScope under one entry
+	static void PushScope(const std::string& name);
+	static void PopScope();
+
 	static FrameDebugInfo GetDebugInfo();
+
+	// EndFrame waits so frames don't start more often than this.
+	// Zero turns the limit off
+	static void SetFrameLimit(float fps);
+	static float GetFrameLimit();
+
+	// Oldest first, at most the history size
+	static List<FrameDebugInfo> GetFrameHistory();
+	static void SetFrameHistorySize(uint32_t size);
 };
 
 }
\ No newline at end of file
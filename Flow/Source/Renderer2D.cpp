@@ -4,6 +4,7 @@
 #include <VolcaniCore/Core/Assert.h>
 
 #include "Graphics/Renderer.h"
+#include "Graphics/Renderer3D.h"
 #include "Graphics/RendererAPI.h"
 #include "Graphics/ShaderLibrary.h"
 #include "Graphics/OrthographicCamera.h"
@@ -13,6 +14,7 @@ using namespace VolcaniCore;
 namespace Magma::Graphics {
 
 static DrawBuffer* s_ScreenBuffer;
+static Ref<RenderPass> s_ScreenPass;
 
 void Renderer2D::Init() {
 	float screenCoords[] =
@@ -40,11 +42,12 @@ void Renderer2D::Init() {
 		.MaxVertexCount = 6
 	};
 
-	s_ScreenBuffer = RendererAPI::Get()->NewDrawBuffer(specs, screenCoords);
+	s_ScreenBuffer = Renderer::GetAPI()->NewDrawBuffer(specs, screenCoords);
 }
 
 void Renderer2D::Close() {
-	RendererAPI::Get()->ReleaseBuffer(s_ScreenBuffer);
+	s_ScreenPass.reset();
+	Renderer::GetAPI()->ReleaseBuffer(s_ScreenBuffer);
 }
 
 void Renderer2D::StartFrame() {
@@ -80,7 +83,18 @@ void Renderer2D::DrawQuad(Ref<Texture> texture, const Transform& t) {
 }
 
 void Renderer2D::DrawText(Ref<Text> text, const Transform& t) {
+	// One em is the text's size in pixels
+	glm::mat4 ems =
+		glm::scale(glm::mat4(1.0f), glm::vec3((float)text->GetTextSize()));
+	Renderer3D::DrawScreenText(text->GetText(),
+		Renderer3D::GetFont(text->GetFontPath()), text->GetTextColor(),
+		t.GetTransform() * ems);
+}
 
+void Renderer2D::DrawText(const std::string& text, Ref<Font> font,
+						  const glm::vec4& color, const Transform& t)
+{
+	Renderer3D::DrawScreenText(text, font, color, t.GetTransform());
 }
 
 void Renderer2D::DrawFullscreenQuad(Ref<Framebuffer> buffer,
@@ -99,9 +113,12 @@ void Renderer2D::DrawFullscreenQuad(Ref<Framebuffer> buffer,
 	if(Renderer::GetPass())
 		command = Renderer::NewCommand(true);
 	else {
-		auto pipeline = ShaderLibrary::Get("Framebuffer");
-		auto* pass = RendererAPI::Get()->NewDrawPass(s_ScreenBuffer, pipeline);
-		command = RendererAPI::Get()->NewDrawCommand(pass);
+		if(!s_ScreenPass) {
+			s_ScreenPass =
+				RenderPass::Create("Screen", ShaderLibrary::Get("Framebuffer"));
+			s_ScreenPass->SetData(s_ScreenBuffer);
+		}
+		command = Renderer::NewCommand(s_ScreenPass);
 	}
 
 	command->ViewportWidth = Application::GetWindow()->GetWidth();
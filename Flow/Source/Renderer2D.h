@@ -10,6 +10,8 @@
 #include "Graphics/Texture.h"
 #include "Graphics/Framebuffer.h"
 
+#include "Font.h"
+
 using namespace VolcaniCore;
 
 namespace Magma::Graphics {
@@ -27,7 +29,12 @@ public:
 	static void DrawQuad(Ref<Texture> quad, const Transform& t = { });
 	static void DrawQuad(const glm::vec4& color, const Transform& t = { });
 
+	// Sized to the text's size in pixels, then transformed
 	static void DrawText(Ref<Text> text, const Transform& t = { });
+	// In window pixels from the bottom left, over everything else. The
+	// scale is the size of an em in pixels
+	static void DrawText(const std::string& text, Ref<Font> font,
+						 const glm::vec4& color, const Transform& t = { });
 
 	static void DrawFullscreenQuad(Ref<Framebuffer> buffer,
 								   AttachmentTarget target);
@@ -1,70 +1,228 @@
 #include "Renderer3D.h"
 
+#include <map>
+#include <tuple>
+
+#include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <VolcaniCore/Core/Application.h>
 #include <VolcaniCore/Core/Assert.h>
 
 #include "Renderer.h"
 #include "RendererAPI.h"
+#include "Graphics/ShaderLibrary.h"
+#include "RingBuffer.h"
+#include "GrowableBuffer.h"
+#include "DebugDraw.h"
 
 using namespace VolcaniCore;
 
 namespace Magma::Graphics {
 
-static DrawBuffer* s_MeshBuffer;
-static DrawBuffer* s_LineBuffer;
+static Ref<GrowableBuffer> s_MeshBuffer;
 static DrawBuffer* s_CubemapBuffer;
 
-static Map<SubMesh*, DrawCommand*> s_Meshes;
-static uint64_t s_InstancesIndex = 0;
+static RingBuffer s_InstanceRing;
+static InstanceFormat s_InstanceFormat = InstanceFormat::Affine;
+static InstanceFormat s_NewInstanceFormat = InstanceFormat::Affine;
+static VertexFormat s_VertexFormat = VertexFormat::Float;
+static VertexFormat s_NewVertexFormat = VertexFormat::Float;
+static GeometryCache s_Geometry;
+
+struct MeshEntry {
+	std::weak_ptr<Mesh> Owner;
+	Ref<MeshLOD> LODs;
+	Ref<MeshletSet> Meshlets;
+};
+
+static Map<Mesh*, MeshEntry> s_Meshes;
+static float s_LODError = 1.0f;
+
+struct QuadInstance {
+	glm::mat4 Transform;
+	glm::vec4 Color;
+	float Texture; // Index into the batch's textures, negative for none
+};
+
+struct QuadBatch {
+	DrawCommand* Command;
+	List<Ref<Texture>> Textures;
+	List<QuadInstance> Instances;
+};
+
+static const uint64_t s_MaxQuadTextures = std::size(Uniforms::QuadTextures);
+
+// A pass with the default shader of a kind, for one output. Commands point
+// at it until the Renderer flushes, so it is only let go of at the start of
+// a frame, after a frame that didn't draw with it
+struct FallbackPass {
+	Ref<RenderPass> Pass;
+	bool Used = false;
+};
+
+using FallbackPasses = Map<Framebuffer*, FallbackPass>;
+
+static Ref<GrowableBuffer> s_QuadBuffer;
+static FallbackPasses s_QuadPasses;
+
+struct PointBatch {
+	DrawCommand* Command;
+	List<PointSprite> Points;
+	glm::vec2 Viewport; // Size of the target the points are drawn into
+};
+
+static Ref<GrowableBuffer> s_PointBuffer;
+static FallbackPasses s_PointPasses;
+
+struct TextInstance {
+	glm::mat4 Transform;
+	glm::vec4 Rect; // In ems, see GlyphQuad
+	glm::vec4 UV;
+	glm::vec4 Color;
+};
+
+struct TextBatch {
+	DrawCommand* Command;
+	Ref<Font> Source;
+	List<TextInstance> Glyphs;
+};
+
+using TextKey = std::tuple<DrawPass*, DrawCommand*, Font*, bool>;
+
+static Ref<GrowableBuffer> s_TextBuffer;
+static FallbackPasses s_TextPasses;
+
+// Kept across frames so their lists keep their memory
+static List<QuadBatch> s_QuadBatches;
+static uint64_t s_QuadBatchCount = 0;
+static std::map<std::pair<DrawPass*, DrawCommand*>, uint64_t> s_OpenQuads;
+static List<PointBatch> s_PointBatches;
+static uint64_t s_PointBatchCount = 0;
+static std::map<std::pair<DrawPass*, DrawCommand*>, uint64_t> s_OpenPoints;
+static List<TextBatch> s_TextBatches;
+static uint64_t s_TextBatchCount = 0;
+static std::map<TextKey, uint64_t> s_OpenText;
+static Map<std::string, Ref<Font>> s_Fonts;
+
+static Ref<Camera> s_Camera;
+static List<DrawPass*> s_CameraPasses;
+
+static void ReleaseUnused(FallbackPasses& passes) {
+	for(auto it = passes.begin(); it != passes.end(); ) {
+		if(!it->second.Used) {
+			it = passes.erase(it);
+			continue;
+		}
+
+		it->second.Used = false;
+		it++;
+	}
+}
+
+static void UploadQuad() {
+	float vertices[] =
+	{
+		-0.5f, -0.5f, 0.0f,  0.0f, 0.0f,
+		 0.5f, -0.5f, 0.0f,  1.0f, 0.0f,
+		 0.5f,  0.5f, 0.0f,  1.0f, 1.0f,
+		-0.5f,  0.5f, 0.0f,  0.0f, 1.0f
+	};
+	uint32_t indices[] = { 0, 1, 2, 2, 3, 0 };
+
+	auto* buffer = s_QuadBuffer->Get();
+	Renderer::GetAPI()
+	->SetBufferData(buffer, DrawBufferIndex::Vertices, vertices, 4, 0);
+	Renderer::GetAPI()
+	->SetBufferData(buffer, DrawBufferIndex::Indices, indices, 6, 0);
+}
 
 void Renderer3D::Init() {
-	BufferLayout vertexLayout =
+	BufferLayout vertexLayout = Vertices::GetLayout(s_VertexFormat);
+	BufferLayout instanceLayout = Instances::GetLayout(s_InstanceFormat);
+
+	DrawBufferSpecification specs
+	{
+		vertexLayout,
+		instanceLayout,
+		64 * 1024, // Indices
+		32 * 1024, // Vertices
+		// One region per frame in flight. Batches reserve exactly as many
+		// slots as they have instances, so this is 16K instances a frame
+		16 * 1024 * RingBuffer::FramesInFlight // Instances
+	};
+
+	BufferLayout quadLayout =
 		{
 			{
 				{ "Position", BufferDataType::Vec3 },
-				{ "Normal",	  BufferDataType::Vec3 },
 				{ "TexCoord", BufferDataType::Vec2 },
 			},
 			true, // Dynamic
 			false // Structure of arrays
 		};
 
-	BufferLayout instanceLayout =
+	BufferLayout quadInstanceLayout =
 		{
 			{
-				{ "Transform", BufferDataType::Mat4 }
+				{ "Transform", BufferDataType::Mat4 },
+				{ "Color",	   BufferDataType::Vec4 },
+				{ "Texture",   BufferDataType::Float },
 			},
 			true, // Dynamic
-			true  // Structure of arrays
+			true  // Instanced
 		};
 
-	DrawBufferSpecification specs
+	DrawBufferSpecification quadSpecs
 	{
-		vertexLayout,
-		instanceLayout,
-		Renderer::MaxIndices,
-		Renderer::MaxVertices,
-		Renderer::MaxInstances
+		quadLayout,
+		quadInstanceLayout,
+		6,
+		4,
+		1024
 	};
 
-	BufferLayout lineLayout =
+	BufferLayout pointLayout =
 		{
 			{
 				{ "Position", BufferDataType::Vec3 },
-				{ "Color",    BufferDataType::Vec3 },
+				{ "Size",	  BufferDataType::Float },
+				{ "Color",	  BufferDataType::Vec4 },
 			},
 			true, // Dynamic
-			false // Instanced
+			true  // Instanced
 		};
 
-	DrawBufferSpecification lineSpecs
+	// The sprite's corners come from gl_VertexID
+	DrawBufferSpecification pointSpecs
 	{
-		lineLayout,
-		{ },
-		1'000'000,
-		2'000'000,
-		0
+		.VertexLayout = { },
+		.InstanceLayout = pointLayout,
+		.MaxIndexCount = 0,
+		.MaxVertexCount = 0,
+		.MaxInstanceCount = 4096
+	};
+
+	BufferLayout textLayout =
+		{
+			{
+				{ "Transform", BufferDataType::Mat4 },
+				{ "Rect",	   BufferDataType::Vec4 },
+				{ "UV",		   BufferDataType::Vec4 },
+				{ "Color",	   BufferDataType::Vec4 },
+			},
+			true, // Dynamic
+			true  // Instanced
+		};
+
+	// One instance per glyph, its corners come from gl_VertexID
+	DrawBufferSpecification textSpecs
+	{
+		.VertexLayout = { },
+		.InstanceLayout = textLayout,
+		.MaxIndexCount = 0,
+		.MaxVertexCount = 0,
+		.MaxInstanceCount = 4096
 	};
 
 	float cubemapVertices[] =
@@ -126,52 +284,376 @@ void Renderer3D::Init() {
 			.MaxVertexCount = 36
 		};
 
-	s_MeshBuffer = RendererAPI::Get()->NewDrawBuffer(specs);
-	s_LineBuffer = RendererAPI::Get()->NewDrawBuffer(lineSpecs);
+	s_MeshBuffer = CreateRef<GrowableBuffer>("Mesh", specs);
+	DebugDraw::Init();
+	s_QuadBuffer = CreateRef<GrowableBuffer>("Quad", quadSpecs);
+	s_PointBuffer = CreateRef<GrowableBuffer>("Point", pointSpecs);
+	s_TextBuffer = CreateRef<GrowableBuffer>("Text", textSpecs);
+	UploadQuad();
+	s_InstanceRing.Init(s_MeshBuffer->Get(), DrawBufferIndex::Instances,
+						Instances::GetStride(s_InstanceFormat),
+						specs.MaxInstanceCount);
+	s_Geometry.Init(s_MeshBuffer->Get(),
+					specs.MaxIndexCount, specs.MaxVertexCount,
+					s_VertexFormat);
 	s_CubemapBuffer =
-		RendererAPI::Get()->NewDrawBuffer(specsCubemap, cubemapVertices);
+		Renderer::GetAPI()->NewDrawBuffer(specsCubemap, cubemapVertices);
 }
 
 void Renderer3D::Close() {
-	RendererAPI::Get()->ReleaseBuffer(s_MeshBuffer);
-	RendererAPI::Get()->ReleaseBuffer(s_LineBuffer);
-	RendererAPI::Get()->ReleaseBuffer(s_CubemapBuffer);
+	s_MeshBuffer.reset();
+	DebugDraw::Close();
+	s_QuadBuffer.reset();
+	s_PointBuffer.reset();
+	s_TextBuffer.reset();
+	s_QuadPasses.clear();
+	s_PointPasses.clear();
+	s_TextPasses.clear();
+	s_QuadBatches.Clear();
+	s_PointBatches.Clear();
+	s_TextBatches.Clear();
+	s_Fonts.clear();
+	s_Meshes.clear();
+	Renderer::GetAPI()->ReleaseBuffer(s_CubemapBuffer);
 }
 
 DrawBuffer* Renderer3D::GetMeshBuffer() {
-	return s_MeshBuffer;
+	return s_MeshBuffer->Get();
 }
 
 DrawBuffer* Renderer3D::GetLineBuffer() {
-	return s_LineBuffer;
+	return DebugDraw::GetBuffer();
 }
 
 DrawBuffer* Renderer3D::GetCubemapBuffer() {
 	return s_CubemapBuffer;
 }
 
+DrawBuffer* Renderer3D::GetQuadBuffer() {
+	return s_QuadBuffer->Get();
+}
+
+DrawBuffer* Renderer3D::GetPointBuffer() {
+	return s_PointBuffer->Get();
+}
+
+DrawBuffer* Renderer3D::GetTextBuffer() {
+	return s_TextBuffer->Get();
+}
+
 void Renderer3D::StartFrame() {
-	s_MeshBuffer->Clear();
-	s_LineBuffer->Clear();
+	// Instances for every frame in flight live in the mesh buffer,
+	// next to the resident geometry
+	s_MeshBuffer->SetDemand(DrawBufferIndex::Instances,
+		s_InstanceRing.GetLastUsed() * RingBuffer::FramesInFlight);
+	s_MeshBuffer->SetDemand(DrawBufferIndex::Indices,
+		s_Geometry.GetIndexDemand());
+	s_MeshBuffer->SetDemand(DrawBufferIndex::Vertices,
+		s_Geometry.GetVertexDemand());
+
+	// A new buffer starts empty, geometry goes up again as it is drawn
+	if(s_MeshBuffer->Resize()) {
+		s_InstanceFormat = s_NewInstanceFormat;
+		s_VertexFormat = s_NewVertexFormat;
+		s_InstanceRing.Init(s_MeshBuffer->Get(), DrawBufferIndex::Instances,
+			Instances::GetStride(s_InstanceFormat),
+			s_MeshBuffer->GetCapacity(DrawBufferIndex::Instances));
+		s_Geometry.Init(s_MeshBuffer->Get(),
+			s_MeshBuffer->GetCapacity(DrawBufferIndex::Indices),
+			s_MeshBuffer->GetCapacity(DrawBufferIndex::Vertices),
+			s_VertexFormat);
+	}
+	s_Geometry.Collect();
+
+	for(auto it = s_Meshes.begin(); it != s_Meshes.end(); ) {
+		if(it->second.Owner.expired())
+			it = s_Meshes.erase(it);
+		else
+			it++;
+	}
+
+	DebugDraw::StartFrame();
+
+	// Last frame's commands were flushed, passes it drew with are kept
+	ReleaseUnused(s_QuadPasses);
+	ReleaseUnused(s_PointPasses);
+	ReleaseUnused(s_TextPasses);
+
+	// The quad itself stays, only the instances are drawn again
+	if(s_QuadBuffer->Resize())
+		UploadQuad();
+	GetQuadBuffer()->Clear(DrawBufferIndex::Instances);
+
+	s_PointBuffer->Resize();
+	GetPointBuffer()->Clear(DrawBufferIndex::Instances);
+
+	s_TextBuffer->Resize();
+	GetTextBuffer()->Clear(DrawBufferIndex::Instances);
 }
 
 void Renderer3D::EndFrame() {
-	s_InstancesIndex = 0;
+	s_InstanceRing.NextFrame();
+}
+
+uint64_t Renderer3D::ReserveInstances(uint64_t count) {
+	return s_InstanceRing.Reserve(count);
+}
+
+void* Renderer3D::StageInstances(uint64_t start, uint64_t count) {
+	return s_InstanceRing.Stage(start, count);
+}
+
+const GeometryRange* Renderer3D::GetGeometry(Ref<Mesh> root, SubMesh& mesh)
+{
+	return s_Geometry.Get(root, mesh);
+}
+
+const GeometryCache& Renderer3D::GetGeometryCache() {
+	return s_Geometry;
+}
+
+// A released mesh may have left its address to a new one
+static MeshEntry* FindMesh(Mesh* mesh) {
+	auto found = s_Meshes.find(mesh);
+	if(found == s_Meshes.end() || found->second.Owner.expired())
+		return nullptr;
+	return &found->second;
+}
+
+void Renderer3D::ReleaseGeometry(Ref<Mesh> mesh) {
+	for(auto& subMesh : mesh->SubMeshes)
+		s_Geometry.Release(subMesh);
+}
+
+static MeshEntry& GetMeshEntry(Ref<Mesh> mesh) {
+	auto* entry = FindMesh(mesh.get());
+	if(!entry) {
+		entry = &s_Meshes[mesh.get()];
+		*entry = { mesh };
+	}
+	return *entry;
+}
+
+static void EraseIfEmpty(Mesh* mesh) {
+	auto found = s_Meshes.find(mesh);
+	if(found->second.LODs || found->second.Meshlets)
+		return;
+	s_Meshes.erase(found);
+}
+
+void Renderer3D::SetLODs(Ref<Mesh> mesh, Ref<MeshLOD> lods) {
+	auto& entry = GetMeshEntry(mesh);
+
+	// New levels could be given the addresses of the old ones, the cache
+	// would take them for geometry it already has
+	if(auto& old = entry.LODs)
+		for(uint32_t i = 1; i < old->GetLevelCount(); i++)
+			for(auto& subMesh : old->GetLevel(i).SubMeshes)
+				s_Geometry.Release(subMesh);
+
+	entry.LODs = lods;
+	EraseIfEmpty(mesh.get());
+}
+
+Ref<MeshLOD> Renderer3D::GetLODs(Mesh* mesh) {
+	auto* entry = FindMesh(mesh);
+	return entry ? entry->LODs : nullptr;
+}
+
+void Renderer3D::SetMeshlets(Ref<Mesh> mesh, Ref<MeshletSet> meshlets) {
+	// Building them reordered the indices of the mesh
+	ReleaseGeometry(mesh);
+
+	GetMeshEntry(mesh).Meshlets = meshlets;
+	EraseIfEmpty(mesh.get());
+}
+
+Ref<MeshletSet> Renderer3D::GetMeshlets(Mesh* mesh) {
+	auto* entry = FindMesh(mesh);
+	return entry ? entry->Meshlets : nullptr;
+}
+
+void Renderer3D::SetLODError(float pixels) {
+	s_LODError = pixels;
+}
+
+float Renderer3D::GetLODError() {
+	return s_LODError;
+}
+
+static void FlushQuads() {
+	auto* buffer = s_QuadBuffer->Get();
+	for(uint64_t i = 0; i < s_QuadBatchCount; i++) {
+		auto& batch = s_QuadBatches[i];
+		auto* command = batch.Command;
+		auto& call = command->Calls[0];
+		uint64_t count = batch.Instances.Count();
+
+		// Dropped for this frame when the quad buffer is full
+		if(s_QuadBuffer->Request(DrawBufferIndex::Instances, count)) {
+			call.InstanceStart = buffer->InstancesCount;
+			call.InstanceCount = count;
+			Renderer::GetAPI()
+			->SetBufferData(buffer, DrawBufferIndex::Instances,
+							batch.Instances.GetBuffer().Get(), count,
+							call.InstanceStart);
+		}
+		else
+			call.InstanceCount = 0;
+
+		for(uint32_t j = 0; j < batch.Textures.Count(); j++)
+			command->UniformData
+			.SetInput(Uniforms::QuadTextures[j],
+					  TextureSlot{ batch.Textures[j], j });
+
+		batch.Command = nullptr;
+		batch.Textures.Clear();
+		batch.Instances.Clear();
+	}
+
+	s_QuadBatchCount = 0;
+	s_OpenQuads.clear();
+}
+
+static void FlushPoints() {
+	auto* buffer = s_PointBuffer->Get();
+	for(uint64_t i = 0; i < s_PointBatchCount; i++) {
+		auto& batch = s_PointBatches[i];
+		auto* command = batch.Command;
+		auto& call = command->Calls[0];
+		uint64_t count = batch.Points.Count();
+
+		if(s_PointBuffer->Request(DrawBufferIndex::Instances, count)) {
+			call.InstanceStart = buffer->InstancesCount;
+			call.InstanceCount = count;
+			Renderer::GetAPI()
+			->SetBufferData(buffer, DrawBufferIndex::Instances,
+							batch.Points.GetBuffer().Get(), count,
+							call.InstanceStart);
+		}
+		else
+			call.InstanceCount = 0;
+
+		// Sizes are in pixels
+		if(!command->ViewportWidth || !command->ViewportHeight)
+			command->UniformData
+			.SetInput(Uniforms::ViewportSize, batch.Viewport);
+		else
+			command->UniformData
+			.SetInput(Uniforms::ViewportSize,
+				glm::vec2(command->ViewportWidth, command->ViewportHeight));
+
+		batch.Command = nullptr;
+		batch.Points.Clear();
+	}
+
+	s_PointBatchCount = 0;
+	s_OpenPoints.clear();
+}
+
+static void FlushText() {
+	auto* buffer = s_TextBuffer->Get();
+	for(uint64_t i = 0; i < s_TextBatchCount; i++) {
+		auto& batch = s_TextBatches[i];
+		auto* command = batch.Command;
+		auto& call = command->Calls[0];
+		uint64_t count = batch.Glyphs.Count();
+
+		if(s_TextBuffer->Request(DrawBufferIndex::Instances, count)) {
+			call.InstanceStart = buffer->InstancesCount;
+			call.InstanceCount = count;
+			Renderer::GetAPI()
+			->SetBufferData(buffer, DrawBufferIndex::Instances,
+							batch.Glyphs.GetBuffer().Get(), count,
+							call.InstanceStart);
+		}
+		else
+			call.InstanceCount = 0;
+
+		// Every glyph is in the atlas by now, it goes up once
+		command->UniformData
+		.SetInput(Uniforms::FontAtlas,
+				  TextureSlot{ batch.Source->GetTexture(), 0 });
+
+		batch.Command = nullptr;
+		batch.Source = nullptr;
+		batch.Glyphs.Clear();
+	}
+
+	s_TextBatchCount = 0;
+	s_OpenText.clear();
+}
+
+void Renderer3D::FlushInstances() {
+	s_InstanceRing.Flush();
+	FlushQuads();
+	FlushPoints();
+	FlushText();
+}
+
+void Renderer3D::SetInstanceFormat(InstanceFormat format) {
+	if(format == s_NewInstanceFormat)
+		return;
+
+	s_NewInstanceFormat = format;
+	s_MeshBuffer->SetInstanceLayout(Instances::GetLayout(format));
+}
+
+InstanceFormat Renderer3D::GetInstanceFormat() {
+	return s_InstanceFormat;
+}
+
+void Renderer3D::SetVertexFormat(VertexFormat format) {
+	if(format == s_NewVertexFormat)
+		return;
+
+	s_NewVertexFormat = format;
+	s_MeshBuffer->SetVertexLayout(Vertices::GetLayout(format));
+}
+
+VertexFormat Renderer3D::GetVertexFormat() {
+	return s_VertexFormat;
+}
+
+void Renderer3D::SetCamera(Ref<Camera> camera) {
+	s_Camera = camera;
+	s_CameraPasses.Clear();
+}
+
+Ref<Camera> Renderer3D::GetCamera() {
+	return s_Camera;
+}
+
+void Renderer3D::AddCameraPass(Ref<RenderPass> pass) {
+	if(pass && !IsCameraPass(pass->Get()))
+		s_CameraPasses.Add(pass->Get());
+}
+
+bool Renderer3D::IsCameraPass(DrawPass* pass) {
+	for(auto* cameraPass : s_CameraPasses)
+		if(cameraPass == pass)
+			return true;
+	return false;
 }
 
 void Renderer3D::Begin(Ref<Camera> camera) {
 	if(!camera)
 		return;
 
+	SetCamera(camera);
+
 	auto* command = Renderer::GetCommand();
 	command->UniformData
-	.SetInput("u_ViewProj", camera->GetViewProjection());
+	.SetInput(Uniforms::ViewProj, camera->GetViewProjection());
 	command->UniformData
-	.SetInput("u_CameraPosition", camera->GetPosition());
+	.SetInput(Uniforms::CameraPosition, camera->GetPosition());
 }
 
 void Renderer3D::End() {
-	s_Meshes.clear();
+	Renderer::GetCommandList().ClearBatches();
+	s_OpenQuads.clear();
+	s_OpenPoints.clear();
+	s_OpenText.clear();
 }
 
 void Renderer3D::DrawSkybox(Ref<Cubemap> cubemap) {
@@ -186,133 +668,283 @@ void Renderer3D::DrawSkybox(Ref<Cubemap> cubemap) {
 	// .SetInput("u_Skybox", TextureSlot{ cubemap, 0 });
 }
 
-static void DrawSubMesh(Ref<Mesh> root, SubMesh& mesh, const glm::mat4& tr,
-						DrawCommand* cmd)
+void Renderer3D::DrawMesh(Ref<Mesh> mesh, const glm::mat4& tr,
+						  DrawCommand* command, uint64_t instance)
 {
-	DrawCommand* command;
-	if(s_Meshes.count(&mesh))
-		command = s_Meshes[&mesh];
-	else {
-		if(Renderer::GetPass()) {
-			command = Renderer::NewCommand();
-			s_Meshes[&mesh] = command;
-		}
-		else {
-			command = RendererAPI::Get()->NewDrawCommand(cmd->Pass);
-			command->UniformData = cmd->UniformData;
-		}
-	}
+	Renderer::GetCommandList().DrawMesh(mesh, tr, command, instance);
+}
 
-	if(!command->VerticesCount) {
-		if(cmd) {
-			command->IndicesIndex = s_MeshBuffer->IndicesCount;
-			command->VerticesIndex = s_MeshBuffer->VerticesCount;
-		}
+// The pass of the command, or the current pass, when it draws from the
+// buffer, and a pass with the default shader otherwise. The fallback draws
+// into the output of the current pass, every output has its own. It is
+// pointed at the buffer again every time, the buffer may have been replaced
+static DrawPass* SelectPass(DrawCommand* command, DrawBuffer* buffer,
+							FallbackPasses& fallbacks,
+							const std::string& shader)
+{
+	auto current = Renderer::GetPass();
+	DrawPass* pass = command ? command->Pass : nullptr;
+	if(!pass && current)
+		pass = current->Get();
+	if(pass && pass->BufferData == buffer)
+		return pass;
+
+	Ref<Framebuffer> output = current ? current->GetOutput() : nullptr;
+	auto& entry = fallbacks[output.get()];
+	if(!entry.Pass)
+		entry.Pass =
+			RenderPass::Create(shader, ShaderLibrary::Get(shader), output);
+	entry.Used = true;
+
+	auto& fallback = entry.Pass;
+	if(fallback->Get()->BufferData != buffer)
+		fallback->SetData(buffer);
+	return fallback->Get();
+}
 
-		if(!command->UniformData && root->Materials) {
-			Material& mat = root->Materials[mesh.MaterialIndex];
-			command->UniformData
-			.SetInput("u_Material.IsTextured", (bool)mat.Diffuse);
-			command->UniformData
-			.SetInput("u_Material.Diffuse", TextureSlot{ mat.Diffuse, 0 });
-			command->UniformData
-			.SetInput("u_Material.Specular", TextureSlot{ mat.Specular, 1 });
-			command->UniformData
-			.SetInput("u_Material.Emissive", TextureSlot{ mat.Emissive, 2 });
+// One instanced call, its instances are placed when the Renderer flushes
+static DrawCommand* NewInstancedCommand(DrawPass* pass, DrawCommand* material)
+{
+	auto* command = Renderer::NewCommand(pass);
+	if(material) {
+		command->UniformData = material->UniformData;
+		Renderer::SetSortMaterial(command, (uint64_t)material);
+	}
+	if(auto camera = Renderer3D::GetCamera())
+		command->UniformData
+		.SetInput(Uniforms::ViewProj, camera->GetViewProjection());
 
-			command->UniformData
-			.SetInput("u_Material.DiffuseColor", mat.DiffuseColor);
-			command->UniformData
-			.SetInput("u_Material.SpecularColor", mat.SpecularColor);
-			command->UniformData
-			.SetInput("u_Material.EmissiveColor", mat.EmissiveColor);
-		}
+	auto& call = command->NewDrawCall();
+	call.Primitive = PrimitiveType::Triangle;
+	call.Partition = PartitionType::Instanced;
+	return command;
+}
 
-		command->DepthTest = DepthTestingMode::On;
-		command->Blending = BlendingMode::Off;
-		command->Culling = CullingMode::Back;
-		command->AddIndices(mesh.Indices);
-		command->AddVertices(mesh.Vertices);
-	}
+static QuadBatch& NewQuadBatch(DrawPass* pass, DrawCommand* material) {
+	if(s_QuadBatchCount == s_QuadBatches.Count())
+		s_QuadBatches.Add({ });
 
-	if(!command->Calls || command->Calls[-1].InstanceCount >= 10'000) {
-		auto& call = command->NewDrawCall();
-		call.Primitive = PrimitiveType::Triangle;
-		call.Partition = PartitionType::Instanced;
-		call.InstanceStart = s_InstancesIndex;
-		s_InstancesIndex += 10'000;
-	}
+	uint64_t index = s_QuadBatchCount++;
+	s_OpenQuads[{ pass, material }] = index;
+
+	auto* command = NewInstancedCommand(pass, material);
+	command->IndicesIndex = 0;
+	command->IndicesCount = 6;
+	command->VerticesIndex = 0;
+	command->VerticesCount = 4;
 
-	auto* buffer = command->Pass->BufferData;
-	auto& call = command->Calls[-1];
-	RendererAPI::Get()
-	->SetBufferData(buffer, DrawBufferIndex::Instances, glm::value_ptr(tr),
-					1, call.InstanceStart + call.InstanceCount++);
+	auto& batch = s_QuadBatches[index];
+	batch.Command = command;
+	return batch;
 }
 
-void Renderer3D::DrawMesh(Ref<Mesh> mesh, const glm::mat4& tr,
-						  DrawCommand* command)
+static void AddQuad(const glm::mat4& tr, const glm::vec4& color,
+					Ref<Texture> texture, DrawCommand* material)
 {
-	for(auto& subMesh : mesh->SubMeshes)
-		DrawSubMesh(mesh, subMesh, tr, command);
+	DrawPass* pass =
+		SelectPass(material, s_QuadBuffer->Get(), s_QuadPasses, "Quad");
+
+	QuadBatch* batch = nullptr;
+	auto open = s_OpenQuads.find({ pass, material });
+	if(open != s_OpenQuads.end())
+		batch = &s_QuadBatches[open->second];
+
+	// A full batch is left as it is, quads after it start the next one
+	float slot = -1.0f;
+	if(texture) {
+		int64_t found = -1;
+		for(uint64_t i = 0; batch && i < batch->Textures.Count(); i++)
+			if(batch->Textures[i] == texture)
+				found = i;
+
+		if(found < 0 && batch
+		&& batch->Textures.Count() == s_MaxQuadTextures)
+			batch = nullptr;
+		if(!batch)
+			batch = &NewQuadBatch(pass, material);
+
+		if(found < 0) {
+			found = batch->Textures.Count();
+			batch->Textures.Add(texture);
+		}
+		slot = (float)found;
+	}
+	else if(!batch)
+		batch = &NewQuadBatch(pass, material);
+
+	batch->Instances.Add({ tr, color, slot });
 }
 
 void Renderer3D::DrawQuad(Ref<Quad> quad, const glm::mat4& tr,
 						  DrawCommand* command)
 {
-	Ref<Mesh> mesh;
 	if(quad->IsTextured)
-		mesh =
-			Mesh::Create(MeshType::Quad,
-						 Material{ .Diffuse = quad->GetTexture() });
+		AddQuad(tr, glm::vec4(1.0f), quad->GetTexture(), command);
 	else
-		mesh = Mesh::Create(MeshType::Quad, quad->GetColor());
-
-	DrawMesh(mesh, tr, command);
+		AddQuad(tr, quad->GetColor(), nullptr, command);
 }
 
 void Renderer3D::DrawQuad(Ref<Texture> texture, const glm::mat4& tr,
 						  DrawCommand* command)
 {
-	DrawQuad(Quad::Create(texture), tr, command);
+	AddQuad(tr, glm::vec4(1.0f), texture, command);
 }
 
 void Renderer3D::DrawQuad(const glm::vec4& color, const glm::mat4& tr,
 						  DrawCommand* command)
 {
-	DrawQuad(Quad::Create(1, 1, color), tr, command);
+	AddQuad(tr, color, nullptr, command);
+}
+
+static PointBatch& GetPointBatch(DrawCommand* material) {
+	DrawPass* pass =
+		SelectPass(material, s_PointBuffer->Get(), s_PointPasses, "Point");
+
+	auto open = s_OpenPoints.find({ pass, material });
+	if(open != s_OpenPoints.end())
+		return s_PointBatches[open->second];
+
+	if(s_PointBatchCount == s_PointBatches.Count())
+		s_PointBatches.Add({ });
+
+	uint64_t index = s_PointBatchCount++;
+	s_OpenPoints[{ pass, material }] = index;
+
+	auto* command = NewInstancedCommand(pass, material);
+	command->Calls[0].VertexCount = 6;
+
+	// The points land in the output of the current pass, or the window
+	auto current = Renderer::GetPass();
+	auto output = current ? current->GetOutput() : nullptr;
+	auto& batch = s_PointBatches[index];
+	batch.Command = command;
+	if(output)
+		batch.Viewport = { output->GetWidth(), output->GetHeight() };
+	else
+		batch.Viewport = { Application::GetWindow()->GetWidth(),
+						   Application::GetWindow()->GetHeight() };
+	return batch;
 }
 
 void Renderer3D::DrawPoint(const Point& point, const glm::mat4& tr,
 						   DrawCommand* command)
 {
-	// TODO(Implement):
+	PointSprite sprite;
+	sprite.Position = point.Position;
+	sprite.Color = glm::vec4(point.Color, 1.0f);
+	DrawPoints(&sprite, 1, tr, command);
+}
+
+void Renderer3D::DrawPoints(const PointSprite* points, uint64_t count,
+							const glm::mat4& tr, DrawCommand* command)
+{
+	if(!count)
+		return;
+
+	auto& batch = GetPointBatch(command);
+	if(tr == glm::mat4(1.0f)) {
+		for(uint64_t i = 0; i < count; i++)
+			batch.Points.Add(points[i]);
+		return;
+	}
+
+	for(uint64_t i = 0; i < count; i++) {
+		PointSprite sprite = points[i];
+		sprite.Position = tr * glm::vec4(sprite.Position, 1.0f);
+		batch.Points.Add(sprite);
+	}
 }
 
 void Renderer3D::DrawLine(const Line& line, const glm::mat4& tr,
 						  DrawCommand* comand)
 {
-	RendererAPI::Get()
-	->SetBufferData(s_LineBuffer, DrawBufferIndex::Vertices, &line.P0,
-					1, s_LineBuffer->VerticesCount);
-	RendererAPI::Get()
-	->SetBufferData(s_LineBuffer, DrawBufferIndex::Vertices, &line.P1,
-					1, s_LineBuffer->VerticesCount);
-
-	uint32_t indices[] =
+	DebugVertex vertices[] =
 	{
-		(uint32_t)s_LineBuffer->IndicesCount,
-		(uint32_t)s_LineBuffer->IndicesCount + 1
+		{ tr * glm::vec4(line.P0.Position, 1.0f), line.P0.Color },
+		{ tr * glm::vec4(line.P1.Position, 1.0f), line.P1.Color }
 	};
-	RendererAPI::Get()
-	->SetBufferData(s_LineBuffer, DrawBufferIndex::Indices, indices,
-					2, s_LineBuffer->IndicesCount);
+	DebugDraw::Lines(vertices, 2);
 }
 
 void Renderer3D::DrawText(Ref<Text> text, const glm::mat4& tr,
 						  DrawCommand* command)
 {
-	// TODO(Implement):
+	DrawText(text->GetText(), GetFont(text->GetFontPath()),
+			 text->GetTextColor(), tr, command);
+}
+
+Ref<Font> Renderer3D::GetFont(const std::string& path) {
+	auto& font = s_Fonts[path.empty() ? Font::DefaultPath : path];
+	if(!font)
+		font = Font::Create(path.empty() ? Font::DefaultPath : path);
+	return font;
+}
+
+static TextBatch& GetTextBatch(DrawCommand* material, Ref<Font> font,
+							   bool screen)
+{
+	DrawPass* pass =
+		SelectPass(material, s_TextBuffer->Get(), s_TextPasses, "Text");
+
+	TextKey key = { pass, material, font.get(), screen };
+	auto open = s_OpenText.find(key);
+	if(open != s_OpenText.end())
+		return s_TextBatches[open->second];
+
+	if(s_TextBatchCount == s_TextBatches.Count())
+		s_TextBatches.Add({ });
+
+	uint64_t index = s_TextBatchCount++;
+	s_OpenText[key] = index;
+
+	auto* command = NewInstancedCommand(pass, material);
+	command->Calls[0].VertexCount = 6;
+	command->Blending = BlendingMode::Greatest;
+	Renderer::SetSortMaterial(command, (uint64_t)font.get());
+
+	if(screen) {
+		auto* window = Application::GetWindow();
+		glm::mat4 projection =
+			glm::ortho(0.0f, (float)window->GetWidth(),
+					   0.0f, (float)window->GetHeight());
+		command->UniformData.SetInput(Uniforms::ViewProj, projection);
+		command->DepthTest = DepthTestingMode::Off;
+	}
+
+	auto& batch = s_TextBatches[index];
+	batch.Command = command;
+	batch.Source = font;
+	return batch;
+}
+
+static void AddText(const std::string& text, Ref<Font> font,
+					const glm::vec4& color, const glm::mat4& tr,
+					DrawCommand* material, bool screen)
+{
+	if(!font || text.empty())
+		return;
+
+	// Shaped once per string, after that drawing it only copies glyphs
+	auto& layout = font->Shape(text);
+	if(!layout.Glyphs)
+		return;
+
+	auto& batch = GetTextBatch(material, font, screen);
+	for(auto& glyph : layout.Glyphs)
+		batch.Glyphs.Add({ tr, glyph.Rect, glyph.UV, color });
+}
+
+void Renderer3D::DrawText(const std::string& text, Ref<Font> font,
+						  const glm::vec4& color, const glm::mat4& tr,
+						  DrawCommand* command)
+{
+	AddText(text, font, color, tr, command, false);
+}
+
+void Renderer3D::DrawScreenText(const std::string& text, Ref<Font> font,
+								const glm::vec4& color, const glm::mat4& tr)
+{
+	AddText(text, font, color, tr, nullptr, true);
 }
 
 }
\ No newline at end of file
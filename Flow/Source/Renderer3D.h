@@ -14,31 +14,107 @@
 #include "Graphics/Texture.h"
 #include "Graphics/Text.h"
 
+#include "Font.h"
+#include "GeometryCache.h"
+#include "InstanceFormat.h"
+#include "MeshLOD.h"
+#include "Meshlet.h"
+#include "VertexFormat.h"
+
 using namespace VolcaniCore;
 
 namespace Magma::Graphics {
 
+// The instance a point is drawn with, a camera facing disc
+struct PointSprite {
+	glm::vec3 Position;
+	float Size = 4.0f; // Pixels
+	glm::vec4 Color = glm::vec4(1.0f);
+};
+
 class Renderer3D {
 public:
 	static void StartFrame();
 	static void EndFrame();
 	static DrawBuffer* GetMeshBuffer();
+	// The buffer DebugDraw gathers lines in
 	static DrawBuffer* GetLineBuffer();
 	static DrawBuffer* GetCubemapBuffer();
+	// One unit quad, drawn once per instance with its own color and texture
+	static DrawBuffer* GetQuadBuffer();
+	static DrawBuffer* GetPointBuffer();
+	static DrawBuffer* GetTextBuffer();
+
+	// Safe to call from any thread
+	static uint64_t ReserveInstances(uint64_t count);
+	// Render thread only, memory for a range returned by ReserveInstances
+	// to be filled with Instances::Encode in the current format. Nothing
+	// reaches the mesh buffer before FlushInstances. Nullptr when the
+	// range doesn't fit this frame
+	static void* StageInstances(uint64_t start, uint64_t count);
+	// Also uploads the quads drawn since the last flush
+	static void FlushInstances();
+
+	// Switches the mesh buffer's instance layout from the next frame
+	static void SetInstanceFormat(InstanceFormat format);
+	static InstanceFormat GetInstanceFormat();
+
+	// Switches the mesh buffer's vertex layout from the next frame, every
+	// submesh is uploaded again in the new format as it is drawn
+	static void SetVertexFormat(VertexFormat format);
+	static VertexFormat GetVertexFormat();
+
+	// Render thread only. Uploads the submesh to the mesh buffer the first
+	// time it is drawn. Nullptr when the mesh buffer can't hold it this
+	// frame, it grows before the next one
+	static const GeometryRange* GetGeometry(Ref<Mesh> root, SubMesh& mesh);
+	static const GeometryCache& GetGeometryCache();
+	// Render thread only. For a mesh whose vertices or indices changed,
+	// it goes up again the next time it is drawn
+	static void ReleaseGeometry(Ref<Mesh> mesh);
+
+	// Meshes with LODs are drawn at the coarsest level whose error covers
+	// at most GetLODError() pixels on screen. Render thread only, never
+	// while lists record on other threads. Nullptr removes them
+	static void SetLODs(Ref<Mesh> mesh, Ref<MeshLOD> lods);
+	static Ref<MeshLOD> GetLODs(Mesh* mesh);
+	static void SetLODError(float pixels);
+	static float GetLODError();
+
+	// In camera passes, the full detail of meshes with meshlets is drawn
+	// without the meshlets that are off screen or face away, when only
+	// part of the mesh is on screen. The same rules as SetLODs
+	static void SetMeshlets(Ref<Mesh> mesh, Ref<MeshletSet> meshlets);
+	static Ref<MeshletSet> GetMeshlets(Mesh* mesh);
+
+	static void SetCamera(Ref<Camera> camera);
+	static Ref<Camera> GetCamera();
+	// Passes that see the scene through the camera. Meshes with meshlets
+	// are culled against it only in these, shadows and other views keep
+	// what the camera can't see. SetCamera starts the list over
+	static void AddCameraPass(Ref<RenderPass> pass);
+	static bool IsCameraPass(DrawPass* pass);
 
 	static void Begin(Ref<Camera> camera);
 	static void End();
 
 	static void DrawSkybox(Ref<Cubemap> cubemap);
 
+	// See CommandList::DrawMesh
 	static void DrawMesh(Ref<Mesh> mesh, const glm::mat4& tr,
-						 DrawCommand* command = nullptr);
+						 DrawCommand* command = nullptr,
+						 uint64_t instance = 0);
 	static void DrawMesh(Ref<Mesh> mesh, const Transform& t = { },
-						 DrawCommand* command = nullptr)
+						 DrawCommand* command = nullptr,
+						 uint64_t instance = 0)
 	{
-		DrawMesh(mesh, t.GetTransform(), command);
+		DrawMesh(mesh, t.GetTransform(), command, instance);
 	}
 
+	// Render thread only. Quads with the same pass and command are drawn
+	// together, up to 16 textures at a time. They use the pass of the
+	// command, or the current pass, when it draws from the quad buffer,
+	// and the Quad shader otherwise
 	static void DrawQuad(Ref<Quad> quad, const glm::mat4& tr,
 						 DrawCommand* command = nullptr);
 	static void DrawQuad(Ref<Quad> quad, const Transform& t = { },
@@ -63,6 +139,7 @@ public:
 		DrawQuad(color, t.GetTransform(), command);
 	}
 
+	// Goes to DebugDraw, drawn by the next DebugDraw::Submit
 	static void DrawLine(const Line& line, const glm::mat4& tr,
 						 DrawCommand* command = nullptr);
 	static void DrawLine(const Line& line, const Transform& t = { },
@@ -71,6 +148,9 @@ public:
 		DrawLine(line, t.GetTransform(), command);
 	}
 
+	// Render thread only. Every point drawn with the same pass and command
+	// goes into one instanced draw, the pass is picked like DrawQuad's,
+	// with the Point shader by default
 	static void DrawPoint(const Point& point, const glm::mat4& tr,
 						  DrawCommand* command = nullptr);
 	static void DrawPoint(const Point& point, const Transform& t = { },
@@ -78,7 +158,11 @@ public:
 	{
 		DrawPoint(point, t.GetTransform(), command);
 	}
+	static void DrawPoints(const PointSprite* points, uint64_t count,
+						   const glm::mat4& tr = glm::mat4(1.0f),
+						   DrawCommand* command = nullptr);
 
+	// In the text's font and color, tr scaling ems to world units
 	static void DrawText(Ref<Text> text, const glm::mat4& tr,
 						 DrawCommand* command = nullptr);
 	static void DrawText(Ref<Text> text, const Transform& t = { },
@@ -87,11 +171,34 @@ public:
 		DrawText(text, t.GetTransform(), command);
 	}
 
+	// Render thread only. Text drawn with the same pass, command and font
+	// goes into one instanced draw, one instance per glyph. tr scales ems to
+	// world units. The pass is picked like DrawQuad's, with the Text shader
+	// by default
+	static void DrawText(const std::string& text, Ref<Font> font,
+						 const glm::vec4& color, const glm::mat4& tr,
+						 DrawCommand* command = nullptr);
+	static void DrawText(const std::string& text, Ref<Font> font,
+						 const glm::vec4& color, const Transform& t = { },
+						 DrawCommand* command = nullptr)
+	{
+		DrawText(text, font, color, t.GetTransform(), command);
+	}
+
+	// Loaded the first time it is asked for, then shared. An empty path is
+	// Font::DefaultPath
+	static Ref<Font> GetFont(const std::string& path = "");
+
 private:
 	static void Init();
 	static void Close();
 
+	// Window pixels from the bottom left, drawn over everything
+	static void DrawScreenText(const std::string& text, Ref<Font> font,
+							   const glm::vec4& color, const glm::mat4& tr);
+
 	friend class Renderer;
+	friend class Renderer2D;
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,93 @@
+#include "RingBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "RendererAPI.h"
+#include "Renderer.h"
+
+using namespace VolcaniCore;
+
+namespace Magma::Graphics {
+
+void RingBuffer::Init(DrawBuffer* buffer, DrawBufferIndex index,
+					  uint64_t stride, uint64_t capacity)
+{
+	m_Buffer = buffer;
+	m_Index = index;
+	m_Stride = stride;
+	m_RegionSize = capacity / FramesInFlight;
+	m_Frame = 0;
+	m_Used = 0;
+	m_Demand = 0;
+	m_LastUsed = 0;
+	m_Peak = 0;
+	m_Staging.clear();
+	m_DirtyStart = UINT64_MAX;
+	m_DirtyEnd = 0;
+}
+
+uint64_t RingBuffer::Reserve(uint64_t count) {
+	m_Demand.fetch_add(count, std::memory_order_relaxed);
+
+	uint64_t used = m_Used.load(std::memory_order_relaxed);
+	do {
+		if(used + count > m_RegionSize)
+			return NoSpace;
+	} while(!m_Used.compare_exchange_weak(used, used + count,
+										  std::memory_order_relaxed));
+
+	return GetRegionStart() + used;
+}
+
+bool RingBuffer::Write(uint64_t start, const void* data, uint64_t count) {
+	void* staged = Stage(start, count);
+	if(!staged)
+		return false;
+
+	std::memcpy(staged, data, count * m_Stride);
+	return true;
+}
+
+void* RingBuffer::Stage(uint64_t start, uint64_t count) {
+	if(start == NoSpace)
+		return nullptr;
+
+	uint64_t offset = start - GetRegionStart();
+	if(offset + count > m_RegionSize)
+		return nullptr;
+
+	uint64_t end = (offset + count) * m_Stride;
+	if(m_Staging.size() < end)
+		m_Staging.resize(end);
+
+	m_DirtyStart = std::min(m_DirtyStart, offset);
+	m_DirtyEnd = std::max(m_DirtyEnd, offset + count);
+	return m_Staging.data() + offset * m_Stride;
+}
+
+void RingBuffer::Flush() {
+	if(m_DirtyStart >= m_DirtyEnd)
+		return;
+
+	Renderer::GetAPI()
+	->SetBufferData(m_Buffer, m_Index,
+					m_Staging.data() + m_DirtyStart * m_Stride,
+					m_DirtyEnd - m_DirtyStart,
+					GetRegionStart() + m_DirtyStart);
+
+	m_DirtyStart = UINT64_MAX;
+	m_DirtyEnd = 0;
+}
+
+void RingBuffer::NextFrame() {
+	Flush();
+
+	m_LastUsed = m_Demand;
+	m_Peak = std::max(m_Peak, m_LastUsed);
+	m_Used = 0;
+	m_Demand = 0;
+	m_Frame = (m_Frame + 1) % FramesInFlight;
+}
+
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include <VolcaniCore/Core/Defines.h>
+
+#include "Graphics/RendererAPI.h"
+
+using namespace VolcaniCore;
+
+namespace Magma::Graphics {
+
+// Splits one stream of a DrawBuffer into FramesInFlight regions, one per
+// frame. Writes are copied into a staging block that lives as long as the
+// ring, and go up with a single SetBufferData per flush. A region is only
+// written again FramesInFlight frames later, so the frame being recorded
+// never overwrites data the GPU may still be reading.
+class RingBuffer {
+public:
+	static const uint32_t FramesInFlight = 3;
+	// Returned by Reserve when the rest of the region is too small
+	static const uint64_t NoSpace = UINT64_MAX;
+
+public:
+	RingBuffer() = default;
+	~RingBuffer() = default;
+
+	RingBuffer(const RingBuffer&) = delete;
+	RingBuffer& operator =(const RingBuffer&) = delete;
+
+	void Init(DrawBuffer* buffer, DrawBufferIndex index, uint64_t stride,
+			  uint64_t capacity);
+
+	// Returns the index of the first element in the buffer, or NoSpace.
+	// A reservation that doesn't fit takes nothing, smaller ones after it
+	// may still fit. Either way it counts towards the demand.
+	// Safe to call from any thread
+	uint64_t Reserve(uint64_t count);
+
+	// Render thread only, start is an index returned by Reserve.
+	// False for NoSpace, nothing is written and the caller drops the data
+	bool Write(uint64_t start, const void* data, uint64_t count);
+	// Like Write, but returns the staging memory for the caller to fill.
+	// Nullptr for NoSpace
+	void* Stage(uint64_t start, uint64_t count);
+	void Flush();
+	void NextFrame();
+
+	uint64_t GetRegionStart() const { return m_Frame * m_RegionSize; }
+	uint64_t GetRegionSize() const { return m_RegionSize; }
+	// Elements asked for, including those that didn't fit
+	uint64_t GetUsed() const { return m_Demand; }
+	uint64_t GetLastUsed() const { return m_LastUsed; }
+	uint64_t GetPeak() const { return m_Peak; }
+
+private:
+	DrawBuffer* m_Buffer = nullptr;
+	DrawBufferIndex m_Index;
+	uint64_t m_Stride = 0;
+	uint64_t m_RegionSize = 0;
+	uint32_t m_Frame = 0;
+
+	std::atomic<uint64_t> m_Used = 0;
+	std::atomic<uint64_t> m_Demand = 0;
+	uint64_t m_LastUsed = 0;
+	uint64_t m_Peak = 0;
+
+	std::vector<uint8_t> m_Staging;
+	uint64_t m_DirtyStart = UINT64_MAX;
+	uint64_t m_DirtyEnd = 0;
+};
+
+}
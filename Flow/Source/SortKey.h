@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+
+#include <glm/common.hpp>
+
+namespace Magma::Graphics {
+
+// Packs the state a command will bind into a single integer, so that
+// sorting the keys groups commands that share state.
+//
+// Opaque:      | Group 20 | 0 | Pipeline 10 | Material 16 | Depth 17 |
+// Translucent: | Group 20 | 1 | ~Depth 17   | Pipeline 10 | Material 16 |
+//
+// Group is the ordering barrier and always wins: commands never move out of
+// the run of commands they were recorded in. Pipeline and material are
+// small IDs handed out in the order they are first seen during a flush, IDs
+// past the last one that fits all share it.
+struct SortKey {
+	static constexpr uint32_t GroupBits    = 20;
+	static constexpr uint32_t PipelineBits = 10;
+	static constexpr uint32_t MaterialBits = 16;
+	static constexpr uint32_t DepthBits    = 17;
+
+	static constexpr uint64_t MaxGroup    = (1ull << GroupBits) - 1;
+	static constexpr uint32_t MaxPipeline = (1u << PipelineBits) - 1;
+	static constexpr uint32_t MaxMaterial = (1u << MaterialBits) - 1;
+
+	static uint64_t Pack(uint32_t group, bool translucent, uint32_t pipeline,
+						 uint32_t material, float depth)
+	{
+		uint64_t g = glm::min<uint64_t>(group, MaxGroup);
+		uint64_t p = glm::min(pipeline, MaxPipeline);
+		uint64_t m = glm::min(material, MaxMaterial);
+		uint64_t d = Quantize(depth);
+
+		uint64_t key = g << (64 - GroupBits);
+		if(!translucent) {
+			key |= p << (MaterialBits + DepthBits);
+			key |= m << DepthBits;
+			key |= d;
+		}
+		else {
+			uint64_t maxDepth = (1ull << DepthBits) - 1;
+			key |= 1ull << (63 - GroupBits);
+			key |= (maxDepth - d) << (PipelineBits + MaterialBits);
+			key |= p << MaterialBits;
+			key |= m;
+		}
+
+		return key;
+	}
+
+	// Depth is the view distance normalized to the camera's far plane
+	static uint64_t Quantize(float depth) {
+		float d = glm::clamp(depth, 0.0f, 1.0f);
+		return (uint64_t)(d * float((1u << DepthBits) - 1));
+	}
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,491 @@
+#include "TrueType.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+
+using namespace VolcaniCore;
+
+namespace Magma::Graphics {
+
+const uint32_t TrueType::Samples = 4;
+
+// Composite glyphs may nest, fonts in use stay well under this
+static const uint32_t s_MaxDepth = 8;
+
+static constexpr uint32_t Tag(const char* name) {
+	return (uint32_t)name[0] << 24 | (uint32_t)name[1] << 16
+		 | (uint32_t)name[2] << 8 | (uint32_t)name[3];
+}
+
+Ref<TrueType> TrueType::Load(const std::string& path) {
+	std::ifstream file(path, std::ios::binary);
+	if(!file)
+		return nullptr;
+
+	std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)),
+							  std::istreambuf_iterator<char>());
+	return Load(std::move(data));
+}
+
+Ref<TrueType> TrueType::Load(std::vector<uint8_t> data) {
+	auto font = CreateRef<TrueType>();
+	font->m_Data = std::move(data);
+	if(!font->ReadTables())
+		return nullptr;
+	return font;
+}
+
+uint32_t TrueType::U8(uint64_t offset) const {
+	return offset < m_Data.size() ? m_Data[offset] : 0;
+}
+
+uint32_t TrueType::U16(uint64_t offset) const {
+	return U8(offset) << 8 | U8(offset + 1);
+}
+
+int32_t TrueType::I16(uint64_t offset) const {
+	return (int16_t)U16(offset);
+}
+
+uint32_t TrueType::U32(uint64_t offset) const {
+	return U16(offset) << 16 | U16(offset + 2);
+}
+
+bool TrueType::ReadTables() {
+	uint32_t version = U32(0);
+	if(version != 0x00010000 && version != Tag("true"))
+		return false;
+
+	uint32_t head = 0, maxp = 0, hhea = 0, cmap = 0;
+	uint32_t tables = U16(4);
+	for(uint32_t i = 0; i < tables; i++) {
+		uint64_t record = 12 + 16 * i;
+		uint32_t offset = U32(record + 8);
+		switch(U32(record)) {
+			case Tag("head"): head = offset; break;
+			case Tag("maxp"): maxp = offset; break;
+			case Tag("hhea"): hhea = offset; break;
+			case Tag("hmtx"): m_Hmtx = offset; break;
+			case Tag("cmap"): cmap = offset; break;
+			case Tag("loca"): m_Loca = offset; break;
+			case Tag("glyf"): m_Glyf = offset; break;
+		}
+	}
+	if(!head || !maxp || !hhea || !cmap || !m_Hmtx || !m_Loca || !m_Glyf)
+		return false;
+
+	m_UnitsPerEm = U16(head + 18);
+	m_LongOffsets = I16(head + 50) != 0;
+	m_GlyphCount = U16(maxp + 4);
+	m_HMetricCount = U16(hhea + 34);
+	if(!m_UnitsPerEm || !m_GlyphCount || !m_HMetricCount)
+		return false;
+
+	// Any Unicode map, the one covering more than the basic plane first
+	int32_t best = -1;
+	uint32_t subtables = U16(cmap + 2);
+	for(uint32_t i = 0; i < subtables; i++) {
+		uint64_t record = cmap + 4 + 8 * i;
+		uint32_t platform = U16(record);
+		uint32_t encoding = U16(record + 2);
+		uint32_t offset = cmap + U32(record + 4);
+		uint32_t format = U16(offset);
+
+		bool unicode =
+			platform == 0 || (platform == 3 && (encoding == 1 || encoding == 10));
+		if(!unicode || (format != 4 && format != 12))
+			continue;
+
+		int32_t rank = format == 12;
+		if(rank > best) {
+			best = rank;
+			m_CharMap = offset;
+		}
+	}
+
+	return best >= 0;
+}
+
+uint32_t TrueType::GetGlyphIndex(uint32_t codepoint) const {
+	// Sequential groups of codepoints
+	if(U16(m_CharMap) == 12) {
+		uint32_t low = 0;
+		uint32_t high = U32(m_CharMap + 12);
+		while(low < high) {
+			uint32_t middle = (low + high) / 2;
+			uint64_t group = m_CharMap + 16 + 12 * middle;
+			if(codepoint < U32(group))
+				high = middle;
+			else if(codepoint > U32(group + 4))
+				low = middle + 1;
+			else
+				return U32(group + 8) + codepoint - U32(group);
+		}
+		return 0;
+	}
+
+	// Segments of the basic plane, sorted by their last codepoint
+	if(codepoint > 0xFFFF)
+		return 0;
+
+	uint32_t segments = U16(m_CharMap + 6) / 2;
+	uint64_t ends = m_CharMap + 14;
+	uint64_t starts = ends + 2 * segments + 2;
+	uint64_t deltas = starts + 2 * segments;
+	uint64_t ranges = deltas + 2 * segments;
+
+	uint32_t low = 0;
+	uint32_t high = segments;
+	while(low < high) {
+		uint32_t middle = (low + high) / 2;
+		if(U16(ends + 2 * middle) < codepoint)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+	if(low == segments)
+		return 0;
+
+	uint32_t start = U16(starts + 2 * low);
+	if(codepoint < start)
+		return 0;
+
+	uint32_t delta = U16(deltas + 2 * low);
+	uint32_t range = U16(ranges + 2 * low);
+	if(!range)
+		return (codepoint + delta) & 0xFFFF;
+
+	// The offset is relative to where it is stored
+	uint32_t glyph = U16(ranges + 2 * low + range + 2 * (codepoint - start));
+	return glyph ? (glyph + delta) & 0xFFFF : 0;
+}
+
+bool TrueType::GetGlyphData(uint32_t glyph, uint64_t& start) const {
+	if(glyph >= m_GlyphCount)
+		return false;
+
+	uint64_t end;
+	if(m_LongOffsets) {
+		start = U32(m_Loca + 4 * glyph);
+		end = U32(m_Loca + 4 * glyph + 4);
+	}
+	else {
+		start = U16(m_Loca + 2 * glyph) * 2;
+		end = U16(m_Loca + 2 * glyph + 2) * 2;
+	}
+
+	// Glyphs without outlines take no space
+	start += m_Glyf;
+	return end + m_Glyf > start;
+}
+
+float TrueType::GetAdvance(uint32_t glyph) const {
+	// Glyphs past the last metric share its advance
+	uint32_t metric = std::min(glyph, m_HMetricCount - 1);
+	return (float)U16(m_Hmtx + 4 * metric);
+}
+
+TrueType::Placement TrueType::Placement::Then(const Placement& child) const {
+	Placement result;
+	result.XX = XX * child.XX + YX * child.XY;
+	result.XY = XY * child.XX + YY * child.XY;
+	result.YX = XX * child.YX + YX * child.YY;
+	result.YY = XY * child.YX + YY * child.YY;
+	result.DX = XX * child.DX + YX * child.DY + DX;
+	result.DY = XY * child.DX + YY * child.DY + DY;
+	return result;
+}
+
+void TrueType::AddOutline(uint32_t glyph, const Placement& placement,
+						  std::vector<Edge>& edges, uint32_t depth) const
+{
+	uint64_t start;
+	if(depth > s_MaxDepth || !GetGlyphData(glyph, start))
+		return;
+
+	int32_t contours = I16(start);
+	if(contours < 0) {
+		AddComposite(start, placement, edges, depth);
+		return;
+	}
+	if(!contours)
+		return;
+
+	uint64_t endPoints = start + 10;
+	uint32_t count = U16(endPoints + 2 * (contours - 1)) + 1;
+	uint64_t at = endPoints + 2 * contours;
+	at += 2 + U16(at); // Instructions
+
+	// Flags may repeat, then every x and every y, each packed as the
+	// point's flags say
+	std::vector<uint8_t> flags(count);
+	for(uint32_t i = 0; i < count; ) {
+		uint8_t flag = U8(at++);
+		uint32_t repeat = flag & 0x08 ? U8(at++) : 0;
+		for(uint32_t r = 0; r <= repeat && i < count; r++)
+			flags[i++] = flag;
+	}
+
+	std::vector<int32_t> xs(count);
+	int32_t x = 0;
+	for(uint32_t i = 0; i < count; i++) {
+		uint8_t flag = flags[i];
+		if(flag & 0x02) {
+			int32_t dx = U8(at++);
+			x += flag & 0x10 ? dx : -dx;
+		}
+		else if(!(flag & 0x10)) {
+			x += I16(at);
+			at += 2;
+		}
+		xs[i] = x;
+	}
+
+	std::vector<glm::vec2> points(count);
+	int32_t y = 0;
+	for(uint32_t i = 0; i < count; i++) {
+		uint8_t flag = flags[i];
+		if(flag & 0x04) {
+			int32_t dy = U8(at++);
+			y += flag & 0x20 ? dy : -dy;
+		}
+		else if(!(flag & 0x20)) {
+			y += I16(at);
+			at += 2;
+		}
+		points[i] = placement.Apply((float)xs[i], (float)y);
+	}
+
+	uint32_t first = 0;
+	for(int32_t c = 0; c < contours; c++) {
+		uint32_t last = U16(endPoints + 2 * c);
+		if(last < first || last >= count)
+			break;
+
+		AddContour(&points[first], &flags[first], last - first + 1, edges);
+		first = last + 1;
+	}
+}
+
+void TrueType::AddComposite(uint64_t start, const Placement& placement,
+							std::vector<Edge>& edges, uint32_t depth) const
+{
+	auto f2dot14 = [this](uint64_t offset) { return I16(offset) / 16384.0f; };
+
+	uint64_t at = start + 10;
+	uint32_t flags;
+	do {
+		flags = U16(at);
+		uint32_t glyph = U16(at + 2);
+		at += 4;
+
+		Placement child;
+		if(flags & 0x0001) {
+			child.DX = (float)I16(at);
+			child.DY = (float)I16(at + 2);
+			at += 4;
+		}
+		else {
+			child.DX = (float)(int8_t)U8(at);
+			child.DY = (float)(int8_t)U8(at + 1);
+			at += 2;
+		}
+
+		// Components anchored to each other's points stay where they are
+		if(!(flags & 0x0002))
+			child.DX = child.DY = 0.0f;
+
+		if(flags & 0x0008) {
+			child.XX = child.YY = f2dot14(at);
+			at += 2;
+		}
+		else if(flags & 0x0040) {
+			child.XX = f2dot14(at);
+			child.YY = f2dot14(at + 2);
+			at += 4;
+		}
+		else if(flags & 0x0080) {
+			child.XX = f2dot14(at);
+			child.XY = f2dot14(at + 2);
+			child.YX = f2dot14(at + 4);
+			child.YY = f2dot14(at + 6);
+			at += 8;
+		}
+
+		AddOutline(glyph, placement.Then(child), edges, depth + 1);
+	} while(flags & 0x0020);
+}
+
+void TrueType::AddContour(const glm::vec2* points, const uint8_t* flags,
+						  uint32_t count, std::vector<Edge>& edges)
+{
+	if(count < 2)
+		return;
+
+	auto line =
+		[&](glm::vec2 p0, glm::vec2 p1)
+		{
+			edges.push_back({ p0, p1 });
+		};
+	auto curve =
+		[&](glm::vec2 p0, glm::vec2 control, glm::vec2 p1)
+		{
+			// About a pixel per segment
+			float length =
+				glm::length(control - p0) + glm::length(p1 - control);
+			uint32_t segments =
+				glm::clamp((uint32_t)std::ceil(length), 1u, 16u);
+
+			glm::vec2 from = p0;
+			for(uint32_t i = 1; i <= segments; i++) {
+				float t = (float)i / segments;
+				float s = 1.0f - t;
+				glm::vec2 to = p0 * (s * s) + control * (2.0f * s * t)
+							 + p1 * (t * t);
+				line(from, to);
+				from = to;
+			}
+		};
+
+	// Off curve points in a row imply an on curve point between them. A
+	// contour without any on curve point starts between its first two
+	uint32_t first = 0;
+	while(first < count && !(flags[first] & 0x01))
+		first++;
+
+	glm::vec2 start;
+	if(first < count)
+		start = points[first];
+	else {
+		first = 0;
+		start = (points[0] + points[1]) * 0.5f;
+	}
+
+	glm::vec2 pen = start;
+	glm::vec2 control;
+	bool hasControl = false;
+	for(uint32_t i = 1; i <= count; i++) {
+		uint32_t index = (first + i) % count;
+		glm::vec2 point = points[index];
+		if(flags[index] & 0x01) {
+			if(hasControl)
+				curve(pen, control, point);
+			else
+				line(pen, point);
+			pen = point;
+			hasControl = false;
+			continue;
+		}
+
+		if(hasControl) {
+			glm::vec2 middle = (control + point) * 0.5f;
+			curve(pen, control, middle);
+			pen = middle;
+		}
+		control = point;
+		hasControl = true;
+	}
+
+	if(hasControl)
+		curve(pen, control, start);
+}
+
+bool TrueType::Rasterize(uint32_t codepoint, uint32_t pixelSize,
+						 GlyphBitmap& out) const
+{
+	uint32_t glyph = GetGlyphIndex(codepoint);
+	if(!glyph || glyph >= m_GlyphCount)
+		return false;
+
+	float scale = (float)pixelSize / m_UnitsPerEm;
+	out = { };
+	out.Advance = GetAdvance(glyph) * scale;
+
+	Placement placement;
+	placement.XX = placement.YY = scale;
+	std::vector<Edge> edges;
+	AddOutline(glyph, placement, edges, 0);
+
+	// Whitespace only moves the pen
+	if(edges.empty())
+		return true;
+
+	glm::vec2 min = edges[0].P0;
+	glm::vec2 max = edges[0].P0;
+	for(auto& edge : edges) {
+		min = glm::min(min, glm::min(edge.P0, edge.P1));
+		max = glm::max(max, glm::max(edge.P0, edge.P1));
+	}
+
+	int32_t left = (int32_t)std::floor(min.x);
+	int32_t bottom = (int32_t)std::floor(min.y);
+	int32_t right = (int32_t)std::ceil(max.x);
+	int32_t top = (int32_t)std::ceil(max.y);
+	if(right <= left || top <= bottom)
+		return true;
+
+	out.Width = right - left;
+	out.Height = top - bottom;
+	out.BearingX = left;
+	out.BearingY = top;
+	out.Coverage.assign(out.Width * out.Height, 0);
+
+	struct Crossing {
+		float X;
+		int32_t Winding;
+	};
+	std::vector<Crossing> crossings;
+	std::vector<uint32_t> hits(out.Width);
+	int32_t columns = out.Width * Samples;
+
+	// Rows go from the top down, filled by the nonzero rule at Samples
+	// heights per row and Samples places per pixel along each
+	for(uint32_t row = 0; row < out.Height; row++) {
+		std::fill(hits.begin(), hits.end(), 0);
+
+		for(uint32_t sample = 0; sample < Samples; sample++) {
+			float y = (float)top - row - (sample + 0.5f) / Samples;
+
+			crossings.clear();
+			for(auto& edge : edges) {
+				float y0 = edge.P0.y;
+				float y1 = edge.P1.y;
+				// Half open, so a point shared by two edges counts once
+				if(y0 == y1 || y < std::min(y0, y1) || y >= std::max(y0, y1))
+					continue;
+
+				float t = (y - y0) / (y1 - y0);
+				float x = edge.P0.x + t * (edge.P1.x - edge.P0.x);
+				crossings.push_back({ x, y1 > y0 ? 1 : -1 });
+			}
+
+			std::sort(crossings.begin(), crossings.end(),
+				[](const Crossing& a, const Crossing& b) { return a.X < b.X; });
+
+			int32_t winding = 0;
+			for(uint64_t i = 0; i + 1 < crossings.size(); i++) {
+				winding += crossings[i].Winding;
+				if(!winding)
+					continue;
+
+				// Places whose center is between the two crossings
+				float x0 = (crossings[i].X - left) * Samples - 0.5f;
+				float x1 = (crossings[i + 1].X - left) * Samples - 0.5f;
+				int32_t from = glm::clamp((int32_t)std::ceil(x0), 0, columns);
+				int32_t to = glm::clamp((int32_t)std::ceil(x1), 0, columns);
+				for(int32_t column = from; column < to; column++)
+					hits[column / Samples]++;
+			}
+		}
+
+		for(uint32_t x = 0; x < out.Width; x++)
+			out.Coverage[row * out.Width + x] =
+				(uint8_t)(hits[x] * 255 / (Samples * Samples));
+	}
+
+	return true;
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <VolcaniCore/Core/Defines.h>
+#include <VolcaniCore/Core/Math.h>
+
+#include "Font.h"
+
+using namespace VolcaniCore;
+
+namespace Magma::Graphics {
+
+// Glyph outlines read out of a TrueType font and filled on the CPU, what
+// a Font created from a file rasterizes with. Covers the Unicode character
+// map, simple and composite glyphs and advances. No hinting or kerning,
+// the glyphs become distance fields anyway.
+class TrueType {
+public:
+	// Nullptr when the file can't be read or has no glyph outlines
+	static Ref<TrueType> Load(const std::string& path);
+	static Ref<TrueType> Load(std::vector<uint8_t> data);
+
+	TrueType() = default;
+	~TrueType() = default;
+
+	// 0 when the font has no glyph for the codepoint
+	uint32_t GetGlyphIndex(uint32_t codepoint) const;
+	uint32_t GetGlyphCount() const { return m_GlyphCount; }
+	uint32_t GetUnitsPerEm() const { return m_UnitsPerEm; }
+
+	// A GlyphRasterizer, pixelSize being the size of an em
+	bool Rasterize(uint32_t codepoint, uint32_t pixelSize,
+				   GlyphBitmap& out) const;
+
+	// Along each axis of a pixel, coverage is counted in Samples^2 steps
+	static const uint32_t Samples;
+
+private:
+	struct Edge {
+		glm::vec2 P0;
+		glm::vec2 P1;
+	};
+
+	// Where a component of a composite glyph goes, font units
+	struct Placement {
+		float XX = 1.0f, XY = 0.0f;
+		float YX = 0.0f, YY = 1.0f;
+		float DX = 0.0f, DY = 0.0f;
+
+		glm::vec2 Apply(float x, float y) const {
+			return glm::vec2(XX * x + YX * y + DX, XY * x + YY * y + DY);
+		}
+		// This placement applied after child
+		Placement Then(const Placement& child) const;
+	};
+
+	std::vector<uint8_t> m_Data;
+	uint32_t m_UnitsPerEm = 0;
+	uint32_t m_GlyphCount = 0;
+	uint32_t m_HMetricCount = 0;
+	bool m_LongOffsets = false;
+
+	uint32_t m_Glyf = 0;
+	uint32_t m_Loca = 0;
+	uint32_t m_Hmtx = 0;
+	uint32_t m_CharMap = 0; // The subtable in use
+
+private:
+	bool ReadTables();
+
+	// Big endian, zero past the end of the data
+	uint32_t U8(uint64_t offset) const;
+	uint32_t U16(uint64_t offset) const;
+	int32_t I16(uint64_t offset) const;
+	uint32_t U32(uint64_t offset) const;
+
+	bool GetGlyphData(uint32_t glyph, uint64_t& start) const;
+	float GetAdvance(uint32_t glyph) const;
+
+	void AddOutline(uint32_t glyph, const Placement& placement,
+					std::vector<Edge>& edges, uint32_t depth) const;
+	void AddComposite(uint64_t start, const Placement& placement,
+					  std::vector<Edge>& edges, uint32_t depth) const;
+	static void AddContour(const glm::vec2* points, const uint8_t* flags,
+						   uint32_t count, std::vector<Edge>& edges);
+};
+
+}
\ No newline at end of file
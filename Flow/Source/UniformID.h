@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace Magma::Graphics {
+
+// A uniform name hashed once, when the ID is made. Comparing and keying by
+// the hash avoids hashing the name on every set. The name is kept as the
+// std::string UniformData is keyed by, so handing it over builds nothing.
+struct UniformID {
+	uint64_t Hash;
+	std::string Name;
+
+	UniformID(const char* name)
+		: Hash(HashName(name)), Name(name) { }
+
+	// FNV-1a
+	static constexpr uint64_t HashName(const char* name) {
+		uint64_t hash = 0xcbf29ce484222325ull;
+		for(; *name; name++) {
+			hash ^= (uint8_t)*name;
+			hash *= 0x100000001b3ull;
+		}
+		return hash;
+	}
+
+	operator const std::string&() const { return Name; }
+
+	bool operator ==(const UniformID& other) const {
+		return Hash == other.Hash;
+	}
+	bool operator !=(const UniformID& other) const {
+		return Hash != other.Hash;
+	}
+};
+
+namespace Uniforms {
+
+inline const UniformID View{ "u_View" };
+inline const UniformID ViewProj{ "u_ViewProj" };
+inline const UniformID CameraPosition{ "u_CameraPosition" };
+inline const UniformID ViewportSize{ "u_ViewportSize" };
+inline const UniformID PixelSize{ "u_PixelSize" };
+
+inline const UniformID Color{ "u_Color" };
+inline const UniformID Texture{ "u_Texture" };
+inline const UniformID Skybox{ "u_Skybox" };
+inline const UniformID BillboardWidth{ "u_BillboardWidth" };
+inline const UniformID BillboardHeight{ "u_BillboardHeight" };
+
+inline const UniformID DirectionalLightCount{ "u_DirectionalLightCount" };
+inline const UniformID PointLightCount{ "u_PointLightCount" };
+inline const UniformID SpotlightCount{ "u_SpotlightCount" };
+
+inline const UniformID InstanceFormat{ "u_InstanceFormat" };
+inline const UniformID UniformScale{ "u_UniformScale" };
+inline const UniformID VertexFormat{ "u_VertexFormat" };
+
+inline const UniformID QuadTextures[] =
+{
+	"u_Textures[0]",  "u_Textures[1]",  "u_Textures[2]",  "u_Textures[3]",
+	"u_Textures[4]",  "u_Textures[5]",  "u_Textures[6]",  "u_Textures[7]",
+	"u_Textures[8]",  "u_Textures[9]",  "u_Textures[10]", "u_Textures[11]",
+	"u_Textures[12]", "u_Textures[13]", "u_Textures[14]", "u_Textures[15]"
+};
+
+inline const UniformID FontAtlas{ "u_Atlas" };
+
+inline const UniformID MaterialIsTextured{ "u_Material.IsTextured" };
+inline const UniformID MaterialDiffuse{ "u_Material.Diffuse" };
+inline const UniformID MaterialSpecular{ "u_Material.Specular" };
+inline const UniformID MaterialEmissive{ "u_Material.Emissive" };
+inline const UniformID MaterialDiffuseColor{ "u_Material.DiffuseColor" };
+inline const UniformID
+	MaterialSpecularColor{ "u_Material.SpecularColor" };
+inline const UniformID
+	MaterialEmissiveColor{ "u_Material.EmissiveColor" };
+
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,113 @@
+#include "VertexFormat.h"
+
+#include <cfloat>
+#include <cstring>
+
+
+using namespace VolcaniCore;
+
+namespace Magma::Graphics::Vertices {
+
+BufferLayout GetLayout(VertexFormat format) {
+	List<BufferElement> elements;
+	if(format == VertexFormat::Float)
+		elements =
+		{
+			{ "Position", BufferDataType::Vec3 },
+			{ "Normal",	  BufferDataType::Vec3 },
+			{ "TexCoord", BufferDataType::Vec2 }
+		};
+	else
+		// The same three locations, so instances stay at location 3
+		elements =
+		{
+			{ "Position", BufferDataType::Vec2 },
+			{ "Normal",	  BufferDataType::Float },
+			{ "TexCoord", BufferDataType::Vec2 }
+		};
+
+	return BufferLayout{ elements, true, false };
+}
+
+uint64_t GetStride(VertexFormat format) {
+	if(format == VertexFormat::Float)
+		return sizeof(Vertex);
+	return 5 * sizeof(float);
+}
+
+glm::vec2 EncodeOctahedral(const glm::vec3& normal) {
+	glm::vec3 n = normal / (glm::abs(normal.x) + glm::abs(normal.y)
+						  + glm::abs(normal.z));
+	if(n.z >= 0.0f)
+		return glm::vec2(n);
+
+	// The lower half folds over the diagonals
+	glm::vec2 sign =
+		glm::vec2(n.x >= 0.0f ? 1.0f : -1.0f, n.y >= 0.0f ? 1.0f : -1.0f);
+	return (1.0f - glm::abs(glm::vec2(n.y, n.x))) * sign;
+}
+
+glm::vec3 DecodeOctahedral(const glm::vec2& point) {
+	glm::vec3 n =
+		glm::vec3(point, 1.0f - glm::abs(point.x) - glm::abs(point.y));
+	if(n.z < 0.0f) {
+		glm::vec2 sign = glm::vec2(n.x >= 0.0f ? 1.0f : -1.0f,
+								   n.y >= 0.0f ? 1.0f : -1.0f);
+		n.x = (1.0f - glm::abs(point.y)) * sign.x;
+		n.y = (1.0f - glm::abs(point.x)) * sign.y;
+	}
+	return glm::normalize(n);
+}
+
+glm::vec4 Encode(VertexFormat format, const Vertex* vertices,
+				 uint64_t count, void* out)
+{
+	if(format == VertexFormat::Float) {
+		std::memcpy(out, vertices, count * sizeof(Vertex));
+		return glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	}
+
+	glm::vec3 min = glm::vec3(FLT_MAX);
+	glm::vec3 max = glm::vec3(-FLT_MAX);
+	for(uint64_t i = 0; i < count; i++) {
+		min = glm::min(min, vertices[i].Position);
+		max = glm::max(max, vertices[i].Position);
+	}
+	if(!count)
+		min = max = glm::vec3(0.0f);
+
+	// A cube around the bounds keeps the scale the same on every axis
+	glm::vec3 size = max - min;
+	float extent = glm::max(size.x, glm::max(size.y, size.z));
+	if(extent == 0.0f)
+		extent = 1.0f;
+
+	// Every word stays below 2^24 so the float holding it is exact
+	auto* dst = static_cast<float*>(out);
+	for(uint64_t i = 0; i < count; i++) {
+		const Vertex& v = vertices[i];
+		glm::vec3 p = (v.Position - min) / extent;
+
+		glm::vec3 normal = v.Normal;
+		if(normal == glm::vec3(0.0f))
+			normal = glm::vec3(0.0f, 0.0f, 1.0f);
+
+		// x | low byte of z, y | high byte of z
+		glm::vec3 q = glm::round(glm::clamp(p, 0.0f, 1.0f) * 65535.0f);
+		uint32_t z = (uint32_t)q.z;
+		*dst++ = float((uint32_t)q.x | (z & 0xFF) << 16);
+		*dst++ = float((uint32_t)q.y | (z >> 8) << 16);
+
+		// 12 bits a side, 2047 being 0
+		glm::vec2 e = EncodeOctahedral(normal);
+		glm::vec2 n = glm::round((glm::clamp(e, -1.0f, 1.0f) + 1.0f) * 2047.0f);
+		*dst++ = float((uint32_t)n.x | (uint32_t)n.y << 12);
+
+		*dst++ = v.TexCoord.x;
+		*dst++ = v.TexCoord.y;
+	}
+
+	return glm::vec4(min, extent);
+}
+
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <VolcaniCore/Core/Defines.h>
+#include <VolcaniCore/Core/Math.h>
+
+#include "Graphics/RendererAPI.h"
+#include "Graphics/Mesh.h"
+
+using namespace VolcaniCore;
+
+namespace Magma::Graphics {
+
+// How mesh vertices are laid out in the mesh buffer. Shaders read
+// locations 0 to 2 and decode them by u_VertexFormat. Quantized vertices
+// pack integers below 2^24 into float attributes as their values, which a
+// float holds exactly, never as bit patterns a driver may flush or change.
+enum class VertexFormat : uint8_t {
+	Float,	  // 32 bytes, position, normal and texture coordinates
+	Quantized // 20 bytes, 16-bit position within the submesh's bounds,
+			  // 24-bit octahedral normal and float coordinates
+};
+
+namespace Vertices {
+
+BufferLayout GetLayout(VertexFormat format);
+uint64_t GetStride(VertexFormat format);
+
+// Normal to a point of the [-1, 1] square, and back
+glm::vec2 EncodeOctahedral(const glm::vec3& normal);
+glm::vec3 DecodeOctahedral(const glm::vec2& point);
+
+// Writes count vertices to out, GetStride(format) bytes apart. Returns
+// what takes decoded positions back to mesh units, an offset in xyz and a
+// uniform scale in w, so normals need nothing new. The identity for Float
+glm::vec4 Encode(VertexFormat format, const Vertex* vertices,
+				 uint64_t count, void* out);
+
+}
+
+}
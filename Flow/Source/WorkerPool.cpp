@@ -0,0 +1,71 @@
+#include "WorkerPool.h"
+
+#include <glm/common.hpp>
+
+namespace Magma::Graphics {
+
+WorkerPool::WorkerPool(uint32_t threadCount) {
+	// hardware_concurrency can report 0 when it doesn't know
+	threadCount = glm::max(threadCount, 1u);
+	for(uint32_t i = 0; i < threadCount; i++)
+		m_Threads.emplace_back([this]() { Work(); });
+}
+
+WorkerPool::~WorkerPool() {
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stopping = true;
+	}
+	m_Condition.notify_all();
+
+	for(auto& thread : m_Threads)
+		thread.join();
+}
+
+void WorkerPool::Post(const Func<void>& job) {
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Jobs.push(job);
+	}
+	m_Condition.notify_one();
+}
+
+void WorkerPool::Run(uint32_t count, const Func<void, uint32_t>& job) {
+	std::mutex mutex;
+	std::condition_variable done;
+	uint32_t remaining = count;
+
+	for(uint32_t i = 0; i < count; i++)
+		Post(
+			[&, i]()
+			{
+				job(i);
+
+				std::lock_guard<std::mutex> lock(mutex);
+				if(--remaining == 0)
+					done.notify_one();
+			});
+
+	std::unique_lock<std::mutex> lock(mutex);
+	done.wait(lock, [&]() { return remaining == 0; });
+}
+
+void WorkerPool::Work() {
+	while(true) {
+		Func<void> job;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Condition.wait(lock,
+				[this]() { return m_Stopping || !m_Jobs.empty(); });
+			if(m_Jobs.empty())
+				return;
+
+			job = std::move(m_Jobs.front());
+			m_Jobs.pop();
+		}
+
+		job();
+	}
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include <VolcaniCore/Core/Defines.h>
+
+using namespace VolcaniCore;
+
+namespace Magma::Graphics {
+
+// Threads started once and kept for the life of the pool, taking jobs from
+// a single queue. Jobs still queued when the pool is destroyed are finished
+// before it returns.
+class WorkerPool {
+public:
+	WorkerPool(uint32_t threadCount = std::thread::hardware_concurrency());
+	~WorkerPool();
+
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator =(const WorkerPool&) = delete;
+
+	// Runs the job on one of the threads, some time later
+	void Post(const Func<void>& job);
+	// Calls the job once with every index below count, spread over the
+	// threads, and returns when all of them are done. Must not be called
+	// from one of the pool's own threads
+	void Run(uint32_t count, const Func<void, uint32_t>& job);
+
+	uint32_t GetThreadCount() const { return (uint32_t)m_Threads.size(); }
+
+private:
+	std::vector<std::thread> m_Threads;
+	std::queue<Func<void>> m_Jobs;
+	std::mutex m_Mutex;
+	std::condition_variable m_Condition;
+	bool m_Stopping = false;
+
+private:
+	void Work();
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,114 @@
+#include "Test.h"
+
+#include <Magma/Graphics/Font.h>
+
+using namespace Magma::Graphics;
+
+// Every codepoint a solid box of size by size pixels, none for 0
+static bool Box(uint32_t codepoint, uint32_t size, GlyphBitmap& out) {
+	if(!codepoint)
+		return false;
+
+	out.Width = size;
+	out.Height = size;
+	out.BearingX = 1;
+	out.BearingY = size;
+	out.Advance = size + 2.0f;
+	out.Coverage.assign(size * size, 255);
+	return true;
+}
+
+static bool Overlap(const glm::vec4& a, const glm::vec4& b) {
+	// Bottom left then top right, the top row of the atlas first
+	return a.x < b.z && b.x < a.z && a.w < b.y && b.w < a.y;
+}
+
+TEST(GlyphsPackWithoutOverlap) {
+	uint32_t pixelSize = 16;
+	uint32_t spread = 4;
+	uint32_t atlasSize = 128;
+	Font font(Box, pixelSize, spread, atlasSize);
+
+	// Glyphs take 24 pixels and a pixel of padding, 5 fit in a shelf and
+	// 5 shelves in the atlas
+	List<glm::vec4> rects;
+	for(uint32_t codepoint = 1; codepoint <= 25; codepoint++) {
+		auto* glyph = font.GetGlyph(codepoint);
+		CHECK(glyph);
+		if(!glyph)
+			continue;
+
+		auto& uv = glyph->UV;
+		CHECK(uv.x >= 0.0f && uv.z <= 1.0f && uv.x < uv.z);
+		CHECK(uv.w >= 0.0f && uv.y <= 1.0f && uv.w < uv.y);
+		CHECK(glyph->Size.x == 24.0f / pixelSize);
+		for(auto& other : rects)
+			CHECK(!Overlap(uv, other));
+		rects.Add(uv);
+	}
+	CHECK(font.GetGlyphCount() == 25);
+
+	// Full, but what was packed stays
+	CHECK(!font.GetGlyph(26));
+	CHECK(font.GetGlyph(1));
+	CHECK(!font.GetGlyph(0));
+
+	font.Clear();
+	CHECK(font.GetGlyphCount() == 0);
+	CHECK(font.GetGlyph(26));
+}
+
+TEST(SDFIsHalfwayOnTheOutline) {
+	GlyphBitmap bitmap;
+	Box('A', 10, bitmap);
+
+	uint32_t spread = 4;
+	uint32_t size = 10 + 2 * spread;
+	std::vector<uint8_t> out(size * size);
+	Font::GenerateSDF(bitmap, spread, out.data(), size);
+
+	auto at = [&](uint32_t x, uint32_t y) { return out[y * size + x]; };
+	uint32_t middle = size / 2;
+
+	// Higher inside, lower outside, the far corners as low as it goes
+	CHECK(at(middle, middle) > 128);
+	CHECK(at(spread, middle) >= 128);
+	CHECK(at(spread - 1, middle) < 128);
+	CHECK(at(0, 0) == 0);
+	CHECK(at(size - 1, size - 1) == 0);
+
+	// Rising towards the middle along a row
+	for(uint32_t x = 1; x <= middle; x++)
+		CHECK(at(x, middle) >= at(x - 1, middle));
+
+	// Symmetric like the box
+	for(uint32_t y = 0; y < size; y++)
+		for(uint32_t x = 0; x < size; x++)
+			CHECK(at(x, y) == at(size - 1 - x, y));
+}
+
+TEST(ShapedStringsAreDroppedLeastRecentFirst) {
+	Font font(Box, 16, 4, 1024);
+
+	auto* first = &font.Shape("first");
+	for(uint32_t i = 1; i < Font::MaxCachedStrings; i++)
+		font.Shape(std::to_string(i));
+	CHECK(font.GetCachedCount() == Font::MaxCachedStrings);
+
+	// Used again, so "1" is the oldest now
+	CHECK(&font.Shape("first") == first);
+	font.Shape("new");
+	CHECK(font.GetCachedCount() == Font::MaxCachedStrings);
+	CHECK(&font.Shape("first") == first);
+}
+
+TEST(ShapeLaysOutLines) {
+	Font font(Box, 16, 4, 1024);
+
+	auto& layout = font.Shape("ab\nc");
+	CHECK(layout.Glyphs.Count() == 3);
+	float advance = 18.0f / 16;
+	CHECK(layout.Size.x == 2 * advance);
+	CHECK(layout.Size.y == 2 * font.GetLineHeight());
+	CHECK(layout.Glyphs[2].Rect.y < layout.Glyphs[0].Rect.y);
+}
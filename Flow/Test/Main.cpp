@@ -0,0 +1,32 @@
+#include "Test.h"
+
+namespace Magma::Test {
+
+List<TestCase>& GetTests() {
+	static List<TestCase> tests;
+	return tests;
+}
+
+uint64_t& GetFailures() {
+	static uint64_t failures = 0;
+	return failures;
+}
+
+}
+
+using namespace Magma::Test;
+
+int main() {
+	uint64_t failed = 0;
+	for(auto& test : GetTests()) {
+		GetFailures() = 0;
+		test.Run();
+
+		std::printf("%s %s\n", GetFailures() ? "FAIL" : "pass", test.Name);
+		failed += GetFailures() != 0;
+	}
+
+	std::printf("%lu of %lu tests failed\n",
+				(unsigned long)failed, (unsigned long)GetTests().Count());
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,91 @@
+#include "Test.h"
+#include "TestMesh.h"
+
+#include <cmath>
+
+#include <Magma/Graphics/MeshLOD.h>
+
+using namespace Magma::Graphics;
+using namespace Magma::Test;
+
+static float Wave(float x, float y) {
+	return 0.1f * std::sin(x * 6.28f) * std::cos(y * 6.28f);
+}
+
+TEST(SimplifyKeepsUnderTarget) {
+	SubMesh grid = MakeGrid(32, Wave);
+
+	for(uint64_t target : { 3000ull, 1200ull, 300ull, 30ull }) {
+		List<uint32_t> out;
+		float error =
+			MeshLOD::Simplify(grid.Vertices, grid.Indices, target, out);
+
+		CHECK(out.Count() <= target);
+		CHECK(out.Count() % 3 == 0);
+		CHECK(error >= 0.0f);
+		for(uint32_t index : out)
+			CHECK(index < grid.Vertices.Count());
+
+		// No triangle collapsed to a line or a point
+		for(uint64_t i = 0; i + 2 < out.Count(); i += 3) {
+			CHECK(out[i] != out[i + 1]);
+			CHECK(out[i + 1] != out[i + 2]);
+			CHECK(out[i] != out[i + 2]);
+		}
+	}
+}
+
+TEST(SimplifyFlatGridWithoutError) {
+	SubMesh grid = MakeGrid(16);
+
+	List<uint32_t> out;
+	float error = MeshLOD::Simplify(grid.Vertices, grid.Indices, 60, out);
+	CHECK(out.Count() <= 60);
+	CHECK(out.Count() > 0);
+	CHECK(error < 1e-4f);
+
+	// Still covers the whole square, facing the same way
+	float area = 0.0f;
+	for(uint64_t i = 0; i + 2 < out.Count(); i += 3) {
+		glm::vec3 a = grid.Vertices[out[i]].Position;
+		glm::vec3 b = grid.Vertices[out[i + 1]].Position;
+		glm::vec3 c = grid.Vertices[out[i + 2]].Position;
+		area += glm::cross(b - a, c - a).z * 0.5f;
+	}
+	CHECK(std::abs(area - 1.0f) < 1e-3f);
+}
+
+TEST(LevelsGetCoarser) {
+	auto mesh = CreateRef<Mesh>();
+	mesh->SubMeshes.Add(MakeGrid(64, Wave));
+	MeshLOD lods(mesh);
+
+	CHECK(lods.GetLevelCount() > 1);
+	CHECK(lods.GetLevel(0).Triangles == 64 * 64 * 2);
+	CHECK(lods.GetLevel(0).SubMeshes.Count() == 0);
+	for(uint32_t i = 1; i < lods.GetLevelCount(); i++) {
+		auto& level = lods.GetLevel(i);
+		CHECK(level.SubMeshes.Count() == 1);
+		CHECK(level.Triangles < lods.GetLevel(i - 1).Triangles);
+		CHECK(level.Error >= lods.GetLevel(i - 1).Error);
+	}
+}
+
+TEST(SelectHoldsNearBoundaries) {
+	auto mesh = CreateRef<Mesh>();
+	mesh->SubMeshes.Add(MakeGrid(64, Wave));
+	MeshLOD lods(mesh);
+
+	// Close up is the full mesh, far away the coarsest level
+	CHECK(lods.Select(1e6f, 1.0f) == 0);
+	CHECK(lods.Select(1e-3f, 1.0f) == lods.GetLevelCount() - 1);
+
+	// Just past the boundary of level 1 it stays when it was picked before
+	float error = lods.GetLevel(1).Error;
+	CHECK(error > 0.0f);
+	float boundary = 1.0f / error;
+	CHECK(lods.Select(boundary * 0.99f, 1.0f) >= 1);
+	CHECK(lods.Select(boundary * 1.01f, 1.0f) == 0);
+	CHECK(lods.Select(boundary * 1.01f, 1.0f, 1) == 1);
+	CHECK(lods.Select(boundary * 0.99f, 1.0f, 0) == 0);
+}
@@ -0,0 +1,95 @@
+#include "Test.h"
+#include "TestMesh.h"
+
+#include <cmath>
+#include <random>
+
+#include <Magma/Graphics/MeshOptimizer.h>
+
+using namespace Magma::Graphics;
+using namespace Magma::Test;
+
+// The triangles of a grid in a random order, like an exporter may leave
+static SubMesh MakeShuffledGrid(uint32_t n) {
+	SubMesh grid = MakeGrid(n, [](float x, float y) { return 0.2f * x * y; });
+
+	std::vector<std::array<uint32_t, 3>> triangles;
+	for(uint64_t i = 0; i < grid.Indices.Count(); i += 3)
+		triangles.push_back(
+			{ grid.Indices[i], grid.Indices[i + 1], grid.Indices[i + 2] });
+
+	std::mt19937 random(1);
+	std::shuffle(triangles.begin(), triangles.end(), random);
+
+	grid.Indices.Clear();
+	for(auto& triangle : triangles)
+		for(uint32_t index : triangle)
+			grid.Indices.Add(index);
+	return grid;
+}
+
+TEST(OptimizeDrawsTheSameTriangles) {
+	auto mesh = CreateRef<Mesh>();
+	mesh->SubMeshes.Add(MakeShuffledGrid(40));
+	auto& subMesh = mesh->SubMeshes[0];
+	auto before = GetTriangles(subMesh.Vertices, subMesh.Indices);
+	uint64_t vertexCount = subMesh.Vertices.Count();
+
+	auto stats = MeshOptimizer::Optimize(mesh);
+	CHECK(stats.Triangles == before.size());
+	CHECK(subMesh.Vertices.Count() == vertexCount);
+	CHECK(GetTriangles(subMesh.Vertices, subMesh.Indices) == before);
+}
+
+TEST(OptimizeDoesNotRaiseACMR) {
+	auto mesh = CreateRef<Mesh>();
+	mesh->SubMeshes.Add(MakeShuffledGrid(40));
+	auto& subMesh = mesh->SubMeshes[0];
+
+	float before =
+		MeshOptimizer::GetACMR(subMesh.Indices, subMesh.Vertices.Count());
+	auto stats = MeshOptimizer::Optimize(mesh);
+	float after =
+		MeshOptimizer::GetACMR(subMesh.Indices, subMesh.Vertices.Count());
+
+	CHECK(std::abs(stats.ACMRBefore - before) < 1e-5f);
+	CHECK(std::abs(stats.ACMRAfter - after) < 1e-5f);
+	CHECK(after <= before);
+	// Shuffled triangles miss the cache about every vertex
+	CHECK(after < before * 0.5f);
+}
+
+TEST(VertexCacheOrderIsAPermutation) {
+	SubMesh grid = MakeShuffledGrid(24);
+	auto before = GetTriangles(grid.Vertices, grid.Indices);
+	float acmr = MeshOptimizer::GetACMR(grid.Indices, grid.Vertices.Count());
+
+	List<uint32_t> clusters;
+	MeshOptimizer::OptimizeVertexCache(grid.Indices, grid.Vertices.Count(),
+									   clusters);
+	CHECK(GetTriangles(grid.Vertices, grid.Indices) == before);
+	CHECK(MeshOptimizer::GetACMR(grid.Indices, grid.Vertices.Count()) <= acmr);
+
+	// Clusters start at triangles, in order, the first at the first
+	CHECK(clusters.Count() > 0);
+	CHECK(clusters[0] == 0);
+	for(uint64_t i = 1; i < clusters.Count(); i++)
+		CHECK(clusters[i] > clusters[i - 1]);
+	CHECK(clusters[-1] < grid.Indices.Count() / 3);
+}
+
+TEST(VertexFetchFollowsFirstUse) {
+	SubMesh grid = MakeShuffledGrid(8);
+	auto before = GetTriangles(grid.Vertices, grid.Indices);
+
+	MeshOptimizer::OptimizeVertexFetch(grid.Vertices, grid.Indices);
+	CHECK(GetTriangles(grid.Vertices, grid.Indices) == before);
+
+	uint32_t next = 0;
+	for(uint32_t index : grid.Indices) {
+		CHECK(index <= next);
+		if(index == next)
+			next++;
+	}
+	CHECK(next == grid.Vertices.Count());
+}
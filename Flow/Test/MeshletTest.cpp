@@ -0,0 +1,132 @@
+#include "Test.h"
+#include "TestMesh.h"
+
+#include <set>
+
+#include <Magma/Graphics/Meshlet.h>
+
+using namespace Magma::Graphics;
+using namespace Magma::Test;
+
+// Looks down -z at the grid from camera, seeing x and y in [min, max]
+static Frustum GetFrustum(float min, float max) {
+	float scale = 2.0f / (max - min);
+	glm::mat4 viewProj(1.0f);
+	viewProj[0][0] = scale;
+	viewProj[1][1] = scale;
+	viewProj[2][2] = -0.1f;
+	viewProj[3][0] = -(max + min) / (max - min);
+	viewProj[3][1] = -(max + min) / (max - min);
+	return Frustum(viewProj);
+}
+
+TEST(MeshletsCoverEveryTriangleOnce) {
+	SubMesh grid = MakeGrid(48);
+	auto before = GetTriangles(grid.Vertices, grid.Indices);
+
+	uint32_t maxTriangles = 124;
+	uint32_t maxVertices = 64;
+	auto meshlets =
+		MeshletSet::Build(grid.Vertices, grid.Indices, maxTriangles,
+						  maxVertices);
+	CHECK(GetTriangles(grid.Vertices, grid.Indices) == before);
+
+	// Back to back from the first index, none empty or over the limits
+	uint32_t next = 0;
+	for(auto& meshlet : meshlets) {
+		CHECK(meshlet.IndexStart == next);
+		CHECK(meshlet.IndexCount > 0);
+		CHECK(meshlet.IndexCount % 3 == 0);
+		CHECK(meshlet.IndexCount / 3 <= maxTriangles);
+
+		std::set<uint32_t> vertices(
+			grid.Indices.begin() + meshlet.IndexStart,
+			grid.Indices.begin() + meshlet.IndexStart + meshlet.IndexCount);
+		CHECK(vertices.size() <= maxVertices);
+
+		// Every corner inside the bounding sphere
+		for(uint32_t vertex : vertices) {
+			float distance =
+				glm::distance(meshlet.Center, grid.Vertices[vertex].Position);
+			CHECK(distance <= meshlet.Radius + 1e-5f);
+		}
+
+		next = meshlet.IndexStart + meshlet.IndexCount;
+	}
+	CHECK(next == grid.Indices.Count());
+}
+
+TEST(MeshletSetBoundsHoldEveryMeshlet) {
+	auto mesh = CreateRef<Mesh>();
+	mesh->SubMeshes.Add(MakeGrid(32));
+	mesh->SubMeshes.Add(MakeGrid(16, [](float x, float) { return x; }));
+
+	MeshletSet set(mesh);
+	uint64_t triangles = 0;
+	for(uint64_t i = 0; i < mesh->SubMeshes.Count(); i++)
+		for(auto& meshlet : set.GetMeshlets(i)) {
+			triangles += meshlet.IndexCount / 3;
+			float distance = glm::distance(set.GetCenter(), meshlet.Center);
+			CHECK(distance + meshlet.Radius <= set.GetRadius() + 1e-5f);
+		}
+
+	CHECK(triangles == set.GetTriangleCount());
+	CHECK(triangles == (32 * 32 + 16 * 16) * 2);
+}
+
+TEST(CullKeepsMeshletsInView) {
+	SubMesh grid = MakeGrid(64);
+	auto meshlets = MeshletSet::Build(grid.Vertices, grid.Indices, 124, 64);
+	glm::vec3 front = glm::vec3(0.5f, 0.5f, 5.0f);
+
+	// Everything in view and facing the camera
+	List<MeshletRange> ranges;
+	auto all =
+		MeshletSet::Cull(meshlets, glm::mat4(1.0f), GetFrustum(-1.0f, 2.0f),
+						 front, ranges);
+	CHECK(all.Meshlets == meshlets.Count());
+	CHECK(all.Culled == 0);
+	CHECK(all.Triangles == grid.Indices.Count() / 3);
+	CHECK(ranges.Count() == 1);
+	CHECK(ranges[0].IndexStart == 0);
+	CHECK(ranges[0].IndexCount == grid.Indices.Count());
+
+	// Only the corner near the origin in view
+	ranges.Clear();
+	auto corner =
+		MeshletSet::Cull(meshlets, glm::mat4(1.0f), GetFrustum(-1.0f, 0.25f),
+						 front, ranges);
+	CHECK(corner.Culled > 0);
+	CHECK(corner.Culled < corner.Meshlets);
+
+	// What is kept is exactly the meshlets that reach into view
+	Frustum frustum = GetFrustum(-1.0f, 0.25f);
+	uint64_t kept = 0;
+	for(auto& meshlet : meshlets) {
+		bool visible = frustum.Intersects(meshlet.Center, meshlet.Radius);
+		bool found = false;
+		for(auto& range : ranges)
+			found |= meshlet.IndexStart >= range.IndexStart
+				  && meshlet.IndexStart + meshlet.IndexCount
+				  <= range.IndexStart + range.IndexCount;
+		CHECK(found == visible);
+		kept += found;
+	}
+	CHECK(kept == corner.Meshlets - corner.Culled);
+
+	// A flat grid seen from behind faces away everywhere
+	ranges.Clear();
+	auto behind =
+		MeshletSet::Cull(meshlets, glm::mat4(1.0f), GetFrustum(-1.0f, 2.0f),
+						 glm::vec3(0.5f, 0.5f, -5.0f), ranges);
+	CHECK(behind.Culled == behind.Meshlets);
+	CHECK(ranges.Count() == 0);
+}
+
+TEST(FrustumContainsOnlyWholeSpheres) {
+	Frustum frustum = GetFrustum(0.0f, 1.0f);
+	CHECK(frustum.Contains(glm::vec3(0.5f, 0.5f, 0.0f), 0.25f));
+	CHECK(!frustum.Contains(glm::vec3(0.9f, 0.5f, 0.0f), 0.25f));
+	CHECK(frustum.Intersects(glm::vec3(0.9f, 0.5f, 0.0f), 0.25f));
+	CHECK(!frustum.Intersects(glm::vec3(2.0f, 0.5f, 0.0f), 0.25f));
+}
@@ -0,0 +1,77 @@
+#include "Test.h"
+
+#include <Magma/Graphics/RangeAllocator.h>
+
+using namespace Magma::Graphics;
+
+TEST(AllocateIsFirstFit) {
+	RangeAllocator allocator;
+	allocator.Init(100);
+
+	uint64_t a, b, c;
+	CHECK(allocator.Allocate(30, a));
+	CHECK(allocator.Allocate(30, b));
+	CHECK(allocator.Allocate(30, c));
+	CHECK(a == 0);
+	CHECK(b == 30);
+	CHECK(c == 60);
+	CHECK(allocator.GetUsed() == 90);
+
+	uint64_t start;
+	CHECK(!allocator.Allocate(20, start));
+
+	// The hole left by b is the first that fits
+	allocator.Free(b, 30);
+	CHECK(allocator.Allocate(10, start));
+	CHECK(start == 30);
+	CHECK(allocator.Allocate(10, start));
+	CHECK(start == 40);
+	CHECK(allocator.Allocate(10, start));
+	CHECK(start == 50);
+	CHECK(allocator.Allocate(10, start));
+	CHECK(start == 90);
+	CHECK(allocator.GetUsed() == allocator.GetCapacity());
+}
+
+TEST(FreedRangesCoalesce) {
+	RangeAllocator allocator;
+	allocator.Init(60);
+
+	uint64_t starts[6];
+	for(auto& start : starts)
+		CHECK(allocator.Allocate(10, start));
+	CHECK(allocator.GetFreeRangeCount() == 0);
+
+	// Apart, then merged with the one before, after and both
+	allocator.Free(starts[1], 10);
+	allocator.Free(starts[4], 10);
+	CHECK(allocator.GetFreeRangeCount() == 2);
+	allocator.Free(starts[2], 10);
+	CHECK(allocator.GetFreeRangeCount() == 2);
+	allocator.Free(starts[3], 10);
+	CHECK(allocator.GetFreeRangeCount() == 1);
+	allocator.Free(starts[0], 10);
+	allocator.Free(starts[5], 10);
+	CHECK(allocator.GetFreeRangeCount() == 1);
+	CHECK(allocator.GetUsed() == 0);
+
+	// Back in one piece
+	uint64_t start;
+	CHECK(allocator.Allocate(60, start));
+	CHECK(start == 0);
+}
+
+TEST(EmptyRangesTakeNoSpace) {
+	RangeAllocator allocator;
+	allocator.Init(10);
+
+	uint64_t start;
+	CHECK(allocator.Allocate(0, start));
+	allocator.Free(start, 0);
+	CHECK(allocator.GetUsed() == 0);
+	CHECK(allocator.GetFreeRangeCount() == 1);
+
+	allocator.Init(0);
+	CHECK(!allocator.Allocate(1, start));
+	CHECK(allocator.Allocate(0, start));
+}
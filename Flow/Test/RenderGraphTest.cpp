@@ -0,0 +1,144 @@
+#include "Test.h"
+
+#include <Magma/Graphics/RenderGraph.h>
+
+using namespace Magma::Graphics;
+using namespace Magma::Test;
+
+static const TransientDesc s_Full{ 1920, 1080, 0 };
+static const TransientDesc s_Half{ 960, 540, 0 };
+
+// Stand-ins for targets, only ever compared. Each one made is new
+static uint32_t s_Created;
+
+static void UseFakeTargets(RenderGraph& graph) {
+	static char s_Targets[1024];
+	s_Created = 0;
+	graph.SetTargetFactory(
+		[](const TransientDesc&, List<Ref<Texture>>&)
+		{
+			auto* target = (Framebuffer*)&s_Targets[s_Created++];
+			return Ref<Framebuffer>(Ref<Framebuffer>(), target);
+		});
+}
+
+static uint32_t s_Runs;
+
+static void Run() {
+	s_Runs++;
+}
+
+TEST(PassesNotReachingAnOutputAreCulled) {
+	RenderGraph graph;
+	UseFakeTargets(graph);
+
+	auto output = graph.Import("Output", nullptr);
+	graph.MarkOutput(output);
+	auto scene = graph.Create("Scene", s_Full);
+	auto debug = graph.Create("Debug", s_Full);
+	auto unread = graph.Create("Unread", s_Half);
+
+	graph.AddPass("Scene", { }, { scene }, Run);
+	graph.AddPass("Debug", { scene }, { debug }, Run);
+	graph.AddPass("Unread", { debug }, { unread }, Run);
+	graph.AddPass("Composite", { scene }, { output }, Run);
+	graph.AddPass("Present", { output }, { }, Run);
+
+	s_Runs = 0;
+	graph.Execute();
+
+	CHECK(!graph.IsCulled("Scene"));
+	CHECK(!graph.IsCulled("Composite"));
+	// Writes nothing the graph can see, so it is kept
+	CHECK(!graph.IsCulled("Present"));
+	// Only read by a pass that is culled itself
+	CHECK(graph.IsCulled("Debug"));
+	CHECK(graph.IsCulled("Unread"));
+	CHECK(s_Runs == 3);
+
+	// Culled passes get no target
+	CHECK(graph.Get(scene));
+	CHECK(!graph.Get(debug));
+	CHECK(!graph.Get(unread));
+	CHECK(graph.GetTargetCount() == 1);
+}
+
+TEST(TransientsAliasWhenLifetimesDontOverlap) {
+	RenderGraph graph;
+	UseFakeTargets(graph);
+
+	auto output = graph.Import("Output", nullptr);
+	graph.MarkOutput(output);
+	auto a = graph.Create("A", s_Full);
+	auto b = graph.Create("B", s_Full);
+	auto c = graph.Create("C", s_Full);
+	auto half = graph.Create("Half", s_Half);
+
+	// A lives over passes 0 and 1, B over 1 and 2, C over 2 and 3
+	graph.AddPass("0", { }, { a }, nullptr);
+	graph.AddPass("1", { a }, { b }, nullptr);
+	graph.AddPass("2", { b }, { c, half }, nullptr);
+	graph.AddPass("3", { c, half }, { output }, nullptr);
+	graph.Compile();
+
+	CHECK(graph.Get(a) != graph.Get(b));
+	CHECK(graph.Get(b) != graph.Get(c));
+	// A is done before C starts
+	CHECK(graph.Get(a) == graph.Get(c));
+	// Another description never shares
+	CHECK(graph.Get(half) != graph.Get(a));
+	CHECK(graph.Get(half) != graph.Get(b));
+	CHECK(graph.GetTargetCount() == 3);
+}
+
+// The graph is rebuilt every frame, the targets stay
+static void BuildFrame(RenderGraph& graph, const TransientDesc& desc) {
+	graph.Clear();
+	auto output = graph.Import("Output", nullptr);
+	graph.MarkOutput(output);
+	auto scene = graph.Create("Scene", desc);
+	graph.AddPass("Scene", { }, { scene }, nullptr);
+	graph.AddPass("Composite", { scene }, { output }, nullptr);
+	graph.Compile();
+}
+
+TEST(PoolIsReusedAcrossFrames) {
+	RenderGraph graph;
+	UseFakeTargets(graph);
+
+	BuildFrame(graph, s_Full);
+	auto target = graph.Get(1);
+	CHECK(target);
+
+	for(uint32_t i = 0; i < 10; i++) {
+		BuildFrame(graph, s_Full);
+		CHECK(graph.Get(1) == target);
+	}
+	CHECK(graph.GetTargetCount() == 1);
+	CHECK(s_Created == 1);
+}
+
+TEST(UnusedTargetsAreReleased) {
+	RenderGraph graph;
+	UseFakeTargets(graph);
+
+	BuildFrame(graph, s_Full);
+	auto full = graph.Get(1);
+
+	// Still kept while it may come back
+	for(uint32_t i = 0; i < RenderGraph::ReleaseAfter; i++)
+		BuildFrame(graph, s_Half);
+	CHECK(graph.GetTargetCount() == 2);
+
+	BuildFrame(graph, s_Full);
+	CHECK(graph.Get(1) == full);
+
+	for(uint32_t i = 0; i <= RenderGraph::ReleaseAfter; i++)
+		BuildFrame(graph, s_Half);
+	CHECK(graph.GetTargetCount() == 1);
+
+	// Made again when it is needed after all
+	BuildFrame(graph, s_Full);
+	CHECK(graph.GetTargetCount() == 2);
+	CHECK(s_Created == 3);
+}
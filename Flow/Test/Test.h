@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdio>
+
+#include <VolcaniCore/Core/Defines.h>
+
+using namespace VolcaniCore;
+
+namespace Magma::Test {
+
+struct TestCase {
+	const char* Name;
+	void (*Run)();
+};
+
+List<TestCase>& GetTests();
+// Checks failed in the test running now
+uint64_t& GetFailures();
+
+}
+
+// Registers a test with the runner in Main.cpp
+#define TEST(Name) \
+	static void Name(); \
+	static const bool Name##Registered = \
+		(Magma::Test::GetTests().Add({ #Name, Name }), true); \
+	static void Name()
+
+// Reports and carries on, so a test shows every check it fails
+#define CHECK(Condition) \
+	do { \
+		if(!(Condition)) { \
+			std::printf("  %s:%d: %s\n", __FILE__, __LINE__, #Condition); \
+			Magma::Test::GetFailures()++; \
+		} \
+	} while(0)
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include <VolcaniCore/Core/Defines.h>
+#include <VolcaniCore/Core/Math.h>
+
+#include "Graphics/Mesh.h"
+
+using namespace VolcaniCore;
+
+namespace Magma::Test {
+
+using Triangle = std::array<float, 9>;
+
+// A unit square of n by n quads facing +z, heights from height(x, y)
+template<typename HeightFunc>
+inline SubMesh MakeGrid(uint32_t n, HeightFunc height) {
+	SubMesh grid;
+	for(uint32_t y = 0; y <= n; y++)
+		for(uint32_t x = 0; x <= n; x++) {
+			float u = (float)x / n;
+			float v = (float)y / n;
+			Vertex vertex;
+			vertex.Position = glm::vec3(u, v, height(u, v));
+			vertex.Normal = glm::vec3(0.0f, 0.0f, 1.0f);
+			vertex.TexCoord = glm::vec2(u, v);
+			grid.Vertices.Add(vertex);
+		}
+
+	for(uint32_t y = 0; y < n; y++)
+		for(uint32_t x = 0; x < n; x++) {
+			uint32_t a = y * (n + 1) + x;
+			uint32_t b = a + 1;
+			uint32_t c = a + n + 1;
+			uint32_t d = c + 1;
+			for(uint32_t i : { a, b, d, a, d, c })
+				grid.Indices.Add(i);
+		}
+
+	return grid;
+}
+
+inline SubMesh MakeGrid(uint32_t n) {
+	return MakeGrid(n, [](float, float) { return 0.0f; });
+}
+
+// Positions of every triangle, each starting from its smallest corner so
+// the winding is kept, sorted. Equal when two index lists draw the same
+inline std::vector<Triangle> GetTriangles(const List<Vertex>& vertices,
+										  const List<uint32_t>& indices)
+{
+	std::vector<Triangle> triangles;
+	for(uint64_t i = 0; i + 2 < indices.Count(); i += 3) {
+		std::array<std::array<float, 3>, 3> corners;
+		for(uint32_t j = 0; j < 3; j++) {
+			auto& p = vertices[indices[i + j]].Position;
+			corners[j] = { p.x, p.y, p.z };
+		}
+		std::rotate(corners.begin(),
+					std::min_element(corners.begin(), corners.end()),
+					corners.end());
+
+		Triangle triangle;
+		for(uint32_t j = 0; j < 9; j++)
+			triangle[j] = corners[j / 3][j % 3];
+		triangles.push_back(triangle);
+	}
+
+	std::sort(triangles.begin(), triangles.end());
+	return triangles;
+}
+
+}
@@ -0,0 +1,36 @@
+-- The tests in this directory, as one console app that exits with 1 when
+-- any of them fails. Included from VolcanicEngine's workspace, with
+-- VolcanicEngineDir set to the engine's root
+project "FlowTest"
+	kind "ConsoleApp"
+	language "C++"
+	cppdialect "C++20"
+	staticruntime "Off"
+
+	targetdir ("%{wks.location}/build/FlowTest/bin")
+	objdir ("%{wks.location}/build/FlowTest/obj")
+
+	files {
+		"*.h",
+		"*.cpp",
+	}
+
+	includedirs {
+		"%{VolcanicEngineDir}/VolcaniCore/src",
+		"%{VolcanicEngineDir}/VolcaniCore/vendor/glm",
+		"%{VolcanicEngineDir}/Magma/src",
+	}
+
+	-- Flow/Source builds into Magma as Magma/Graphics
+	links {
+		"Magma",
+		"VolcaniCore",
+	}
+
+	filter "configurations:Debug"
+		runtime "Debug"
+		symbols "on"
+
+	filter "configurations:Release"
+		runtime "Release"
+		optimize "on"